@@ -3,6 +3,7 @@
 #include "../Core/Template.h"
 #include "../Core/Memory.h"
 #include "../Core/Assertion.h"
+#include "../Windows/VirtualMemory.h"
 
 namespace EDX
 {
@@ -369,6 +370,8 @@ namespace EDX
 				// Avoid calling Memory::AlignedRealloc( nullptr, 0 ) as ANSI C mandates returning a valid pointer which is not what we want.
 				if (Data || NumElements)
 				{
+					EDX_MEMORY_TAG_SCOPE_IF_UNTAGGED(Containers);
+
 					//check(((uint64)NumElements*(uint64)ElementTypeInfo.GetSize() < (uint64)INT_MAX));
 					Data = (ScriptContainerElement*)Memory::AlignedRealloc(Data, NumElements*NumBytesPerElement, Alignment);
 				}
@@ -480,6 +483,8 @@ namespace EDX
 				// Avoid calling Memory::AlignedRealloc( nullptr, 0 ) as ANSI C mandates returning a valid pointer which is not what we want.
 				if (Data || NumElements)
 				{
+					EDX_MEMORY_TAG_SCOPE_IF_UNTAGGED(Containers);
+
 					//check(((uint64)NumElements*(uint64)ElementTypeInfo.GetSize() < (uint64)INT_MAX));
 					Data = (ScriptContainerElement*)Memory::AlignedRealloc(Data, NumElements*NumBytesPerElement);
 				}
@@ -531,6 +536,174 @@ namespace EDX
 		enum { IsZeroConstruct = true };
 	};
 
+#if defined(_WIN64)
+#define DEFAULT_VIRTUAL_RESERVE_SIZE (uint64(64) << 30)
+#else
+#define DEFAULT_VIRTUAL_RESERVE_SIZE (uint64(512) << 20)
+#endif
+
+	/**
+	* The virtual allocation policy reserves ReserveSize bytes of address space on the first allocation and commits
+	* pages at the end of it as the container grows. Elements are never relocated, so growing costs no copy, doesn't
+	* need the old and new buffers to coexist and leaves pointers to the elements valid. Shrinking decommits the
+	* unused tail. Only the address space is reserved upfront, physical memory is used for touched pages only.
+	*
+	* Growing beyond ReserveSize bytes is an error.
+	*/
+	template<uint64 ReserveSize = DEFAULT_VIRTUAL_RESERVE_SIZE>
+	class VirtualAllocator
+	{
+	public:
+
+		enum { NeedsElementType = false };
+		enum { RequireRangeCheck = true };
+
+		// Pages are committed in steps of this many bytes
+		enum { CommitGranularity = 65536 };
+
+		class ForAnyElementType
+		{
+		private:
+			/** A pointer to the container's elements, the base of the reserved range. */
+			ScriptContainerElement* Data;
+
+			/** Number of bytes committed at the start of the range. */
+			SIZE_T CommittedBytes;
+
+			/** Rounds an element count up to fill whole commit steps, without exceeding the reserved range. */
+			static __forceinline int32 RoundToCommitGranularity(int32 NumElements, SIZE_T NumBytesPerElement)
+			{
+				const SIZE_T NumBytes = Align(SIZE_T(NumElements) * NumBytesPerElement, int32(CommitGranularity));
+				const SIZE_T MaxElements = Math::Min(SIZE_T(ReserveSize) / NumBytesPerElement, SIZE_T(int32(Math::EDX_INFINITY)));
+
+				return int32(Math::Min(NumBytes / NumBytesPerElement, MaxElements));
+			}
+
+			void Release()
+			{
+				if (Data)
+				{
+					VirtualMemory::Release(Data);
+					Data = nullptr;
+					CommittedBytes = 0;
+				}
+			}
+
+		public:
+			/** Default constructor. */
+			ForAnyElementType()
+				: Data(nullptr)
+				, CommittedBytes(0)
+			{}
+
+			ForAnyElementType(const ForAnyElementType&) = delete;
+			ForAnyElementType& operator=(const ForAnyElementType&) = delete;
+
+			/**
+			* Moves the state of another allocator into this one.
+			* Assumes that the allocator is currently empty, i.e. memory may be allocated but any existing elements have already been destructed (if necessary).
+			* @param Other - The allocator to move the state from.  This allocator should be left in a valid empty state.
+			*/
+			__forceinline void MoveToEmpty(ForAnyElementType& Other)
+			{
+				Assert(this != &Other);
+
+				Release();
+
+				Data = Other.Data;
+				CommittedBytes = Other.CommittedBytes;
+				Other.Data = nullptr;
+				Other.CommittedBytes = 0;
+			}
+
+			/** Destructor. */
+			__forceinline ~ForAnyElementType()
+			{
+				Release();
+			}
+
+			// ContainerAllocatorInterface
+			__forceinline ScriptContainerElement* GetAllocation() const
+			{
+				return Data;
+			}
+			void ResizeAllocation(int32 PreviousNumElements, int32 NumElements, SIZE_T NumBytesPerElement)
+			{
+				if (NumElements == 0)
+				{
+					Release();
+					return;
+				}
+
+				const SIZE_T NewBytes = Align(SIZE_T(NumElements) * NumBytesPerElement, int32(CommitGranularity));
+				Assertf(NewBytes <= ReserveSize, EDX_TEXT("VirtualAllocator reserved range exhausted"));
+
+				if (!Data)
+				{
+					Data = (ScriptContainerElement*)VirtualMemory::Reserve(SIZE_T(ReserveSize));
+					Assertf(Data != nullptr, EDX_TEXT("Failed to reserve address space"));
+				}
+
+				if (NewBytes > CommittedBytes)
+				{
+					const bool bCommitted = VirtualMemory::Commit((uint8*)Data + CommittedBytes, NewBytes - CommittedBytes);
+					Assertf(bCommitted, EDX_TEXT("Failed to commit memory"));
+				}
+				else if (NewBytes < CommittedBytes)
+				{
+					VirtualMemory::Decommit((uint8*)Data + NewBytes, CommittedBytes - NewBytes);
+				}
+
+				CommittedBytes = NewBytes;
+			}
+			__forceinline int32 CalculateSlackReserve(int32 NumElements, int32 NumBytesPerElement) const
+			{
+				return RoundToCommitGranularity(NumElements, NumBytesPerElement);
+			}
+			__forceinline int32 CalculateSlackShrink(int32 NumElements, int32 NumAllocatedElements, int32 NumBytesPerElement) const
+			{
+				const int32 Retval = DefaultCalculateSlackShrink(NumElements, NumAllocatedElements, NumBytesPerElement, false);
+				return Retval > 0 ? Math::Min(RoundToCommitGranularity(Retval, NumBytesPerElement), NumAllocatedElements) : 0;
+			}
+			__forceinline int32 CalculateSlackGrow(int32 NumElements, int32 NumAllocatedElements, int32 NumBytesPerElement) const
+			{
+				return RoundToCommitGranularity(DefaultCalculateSlackGrow(NumElements, NumAllocatedElements, NumBytesPerElement, false), NumBytesPerElement);
+			}
+
+			SIZE_T GetAllocatedSize(int32 NumAllocatedElements, SIZE_T NumBytesPerElement) const
+			{
+				return CommittedBytes;
+			}
+
+			bool HasAllocation()
+			{
+				return !!Data;
+			}
+		};
+
+		template<typename ElementType>
+		class ForElementType : public ForAnyElementType
+		{
+		public:
+
+			/** Default constructor. */
+			ForElementType()
+			{}
+
+			__forceinline ElementType* GetAllocation() const
+			{
+				return (ElementType*)ForAnyElementType::GetAllocation();
+			}
+		};
+	};
+
+	template <uint64 ReserveSize>
+	struct AllocatorTraits<VirtualAllocator<ReserveSize>> : AllocatorTraitsBase<VirtualAllocator<ReserveSize>>
+	{
+		enum { SupportsMove = true };
+		enum { IsZeroConstruct = true };
+	};
+
 	class DefaultAllocator;
 
 	/**
@@ -2592,6 +2592,10 @@ namespace EDX
 	// Static array
 	template<typename T, int Size>
 	using StaticArray = Array<T, FixedAllocator<Size>>;
+
+	// Array growing in place inside a reserved address range, see VirtualAllocator
+	template<typename T, uint64 ReserveSize = DEFAULT_VIRTUAL_RESERVE_SIZE>
+	using VirtualArray = Array<T, VirtualAllocator<ReserveSize>>;
 }
 
 //
@@ -0,0 +1,1514 @@
+#pragma once
+
+#include "../Core/Types.h"
+#include "../Core/Template.h"
+#include "../Core/Memory.h"
+#include "AllocationPolicies.h"
+#include "Array.h"
+#include "Map.h"
+
+#include <initializer_list>
+
+namespace EDX
+{
+	namespace BTree_Private
+	{
+		/** Target node size, four cache lines. Nodes of large elements take as many cache lines as four elements need. */
+		enum { NodeBytes = 256 };
+		enum { CacheLineBytes = 64 };
+
+		/** Node allocated as a whole number of cache lines, so that nodes stay line aligned in the node arrays. */
+		template<typename BaseType, int32 NumPadBytes>
+		struct PaddedNode : BaseType
+		{
+			uint8 Padding[NumPadBytes];
+		};
+
+		template<typename BaseType>
+		struct PaddedNode<BaseType, 0> : BaseType
+		{
+		};
+
+		template<typename BaseType>
+		struct CacheLineNode
+		{
+			enum { PaddedSize = (sizeof(BaseType) + CacheLineBytes - 1) / CacheLineBytes * CacheLineBytes };
+			typedef PaddedNode<BaseType, PaddedSize - sizeof(BaseType)> Type;
+		};
+
+		/** @return The number of items of ItemBytes bytes which fit in a node next to HeaderBytes, at least 4. */
+		template<SIZE_T HeaderBytes, SIZE_T ItemBytes>
+		struct NodeCapacity
+		{
+			enum { Fit = (NodeBytes - HeaderBytes) / ItemBytes };
+			enum { Value = Fit > 4 ? Fit : 4 };
+		};
+	}
+
+	/**
+	* Default key functions for BTreeSet, elements are their own key and ordered with operator<.
+	*/
+	template<typename ElementType>
+	struct DefaultBTreeKeyFuncs
+	{
+		typedef ElementType KeyType;
+		typedef typename TypeTraits<ElementType>::ConstInitType KeyInitType;
+
+		static __forceinline KeyInitType GetSetKey(KeyInitType Element)
+		{
+			return Element;
+		}
+
+		static __forceinline bool Less(KeyInitType A, KeyInitType B)
+		{
+			return A < B;
+		}
+	};
+
+	/** Key functions of BTreeMap, pairs are ordered by key with operator<. */
+	template<typename InKeyType, typename ValueType>
+	struct BTreeMapKeyFuncs
+	{
+		typedef InKeyType KeyType;
+		typedef typename TypeTraits<KeyType>::ConstInitType KeyInitType;
+
+		static __forceinline KeyInitType GetSetKey(const Pair<KeyType, ValueType>& Element)
+		{
+			return Element.Key;
+		}
+
+		static __forceinline bool Less(KeyInitType A, KeyInitType B)
+		{
+			return A < B;
+		}
+	};
+
+	template<typename KeyType, typename ValueType, typename Allocator>
+	class BTreeMap;
+
+	/**
+	* Ordered set, a B+ tree with elements in the leaves and copies of separating keys in the inner nodes.
+	*
+	* Nodes hold as many elements or keys as fit in four cache lines and are padded to whole cache lines, so a
+	* lookup touches a handful of lines per level and the tree is only a few levels deep. Leaves are linked in key
+	* order, iteration and range scans walk the leaves without going back up the tree.
+	*
+	* Nodes are stored in two arrays using the Allocator policy, the leaves and the inner nodes, and refer to each
+	* other by index; the default policy aligns them on cache lines. Freed nodes are kept for reuse. Elements are
+	* relocated bitwise when the node arrays grow or nodes split and merge, so pointers to elements and iterators
+	* are invalidated by any addition or removal. Duplicate keys are not supported.
+	*/
+	template<typename InElementType, typename KeyFuncs = DefaultBTreeKeyFuncs<InElementType>, typename Allocator = AlignedHeapAllocator<BTree_Private::CacheLineBytes>>
+	class BTreeSet
+	{
+		template<typename, typename, typename>
+		friend class BTreeMap;
+
+	public:
+		typedef InElementType ElementType;
+
+	private:
+		typedef typename KeyFuncs::KeyType     KeyType;
+		typedef typename KeyFuncs::KeyInitType KeyInitType;
+
+		enum { LeafCapacity = BTree_Private::NodeCapacity<3 * sizeof(int32), sizeof(ElementType)>::Value };
+		enum { InnerCapacity = BTree_Private::NodeCapacity<2 * sizeof(int32), sizeof(KeyType) + sizeof(int32)>::Value };
+
+		/** Nodes other than the root are kept at least half full. */
+		enum { MinLeafElements = LeafCapacity / 2 };
+		enum { MinInnerKeys = InnerCapacity / 2 };
+
+		struct LeafNodeBase
+		{
+			int32 NumElements;
+
+			/** Neighbor leaves in key order. Next also links the free leaves. */
+			int32 Prev;
+			int32 Next;
+
+			TypeCompatibleBytes<ElementType> Elements[LeafCapacity];
+		};
+
+		/** Every key in Children[i] is less than Keys[i], which is not greater than any key in Children[i + 1]. */
+		struct InnerNodeBase
+		{
+			int32 NumKeys;
+
+			TypeCompatibleBytes<KeyType> Keys[InnerCapacity];
+
+			/** Inner nodes one level down, or leaves. Children[0] also links the free inner nodes. */
+			int32 Children[InnerCapacity + 1];
+		};
+
+		typedef typename BTree_Private::CacheLineNode<LeafNodeBase>::Type  LeafNode;
+		typedef typename BTree_Private::CacheLineNode<InnerNodeBase>::Type InnerNode;
+
+		/** New right sibling of a node that split, and the key separating the two. */
+		struct SplitResult
+		{
+			SplitResult()
+				: RightNode(INDEX_NONE)
+			{
+			}
+
+			TypeCompatibleBytes<KeyType> Separator;
+			int32 RightNode;
+		};
+
+	public:
+		BTreeSet()
+			: NumElements(0)
+			, Root(INDEX_NONE)
+			, Height(0)
+			, FirstLeaf(INDEX_NONE)
+			, FreeLeaves(INDEX_NONE)
+			, FreeInners(INDEX_NONE)
+		{
+		}
+
+		BTreeSet(std::initializer_list<ElementType> InitList)
+			: BTreeSet()
+		{
+			Append(InitList);
+		}
+
+		BTreeSet(const BTreeSet& Other)
+			: BTreeSet()
+		{
+			*this = Other;
+		}
+
+		BTreeSet(BTreeSet&& Other)
+			: BTreeSet()
+		{
+			*this = Move(Other);
+		}
+
+		~BTreeSet()
+		{
+			DestructNodes();
+		}
+
+		BTreeSet& operator=(const BTreeSet& Other)
+		{
+			if (this != &Other)
+			{
+				// Other is already sorted, build the tree bottom up
+				ConstIterator OtherIt(Other);
+				BuildSortedImpl(Other.NumElements, [&OtherIt](void* Dest)
+				{
+					new(Dest) ElementType(*OtherIt);
+					++OtherIt;
+				});
+			}
+			return *this;
+		}
+
+		BTreeSet& operator=(BTreeSet&& Other)
+		{
+			if (this != &Other)
+			{
+				DestructNodes();
+				Leaves = Move(Other.Leaves);
+				Inners = Move(Other.Inners);
+
+				NumElements = Other.NumElements;
+				Root = Other.Root;
+				Height = Other.Height;
+				FirstLeaf = Other.FirstLeaf;
+				FreeLeaves = Other.FreeLeaves;
+				FreeInners = Other.FreeInners;
+
+				Other.ResetRoot();
+			}
+			return *this;
+		}
+
+		/**
+		* Adds an element to the set, replacing the element with the same key if there is one.
+		*
+		* @param	bIsAlreadyInSetPtr	[out]	Optional pointer to bool that will be set depending on whether the key was already in the set
+		* @return	A reference to the element stored in the set, valid until the next change to the set.
+		*/
+		__forceinline ElementType& Add(const ElementType& InElement, bool* bIsAlreadyInSetPtr = nullptr)
+		{
+			return EmplaceByKey(KeyFuncs::GetSetKey(InElement), InElement, bIsAlreadyInSetPtr);
+		}
+		__forceinline ElementType& Add(ElementType&& InElement, bool* bIsAlreadyInSetPtr = nullptr)
+		{
+			return EmplaceByKey(KeyFuncs::GetSetKey(InElement), Move(InElement), bIsAlreadyInSetPtr);
+		}
+
+		/**
+		* Constructs an element from Args and adds it to the set, replacing the element with the same key if there is one.
+		*
+		* @param	bIsAlreadyInSetPtr	[out]	Optional pointer to bool that will be set depending on whether the key was already in the set
+		* @return	A reference to the element stored in the set, valid until the next change to the set.
+		*/
+		template<typename ArgsType>
+		ElementType& Emplace(ArgsType&& Args, bool* bIsAlreadyInSetPtr = nullptr)
+		{
+			// The key is only known once the element is built
+			TypeCompatibleBytes<ElementType> NewElementBytes;
+			ElementType& NewElement = *new(&NewElementBytes) ElementType(Forward<ArgsType>(Args));
+
+			ElementType& Result = EmplaceByKey(KeyFuncs::GetSetKey(NewElement), Move(NewElement), bIsAlreadyInSetPtr);
+			DestructItems(&NewElement, 1);
+			return Result;
+		}
+
+		void Append(std::initializer_list<ElementType> InitList)
+		{
+			for (const ElementType& Element : InitList)
+			{
+				Add(Element);
+			}
+		}
+
+		template<typename ArrayAllocator>
+		void Append(const Array<ElementType, ArrayAllocator>& InElements)
+		{
+			for (const ElementType& Element : InElements)
+			{
+				Add(Element);
+			}
+		}
+
+		/**
+		* Replaces the content of the set with elements sorted by key, building full leaves and the inner levels
+		* bottom up in linear time instead of adding the elements one by one. Elements with equal keys must be
+		* adjacent, the last of them is kept. The elements are moved out of InElements, which is left empty.
+		*/
+		template<typename ArrayAllocator>
+		void BuildFromSorted(Array<ElementType, ArrayAllocator>&& InElements)
+		{
+			ElementType* Source = InElements.Data();
+			BuildSortedImpl(InElements.Size(), [&Source](void* Dest)
+			{
+				new(Dest) ElementType(Move(*Source++));
+			});
+			InElements.Reset();
+		}
+
+		/** Copying version of BuildFromSorted. */
+		void BuildFromSorted(const ElementType* InElements, int32 Num)
+		{
+			BuildSortedImpl(Num, [&InElements](void* Dest)
+			{
+				new(Dest) ElementType(*InElements++);
+			});
+		}
+
+		/**
+		* Removes the element with the given key.
+		* @return The number of elements removed, 0 or 1.
+		*/
+		int32 Remove(KeyInitType Key)
+		{
+			if (Root == INDEX_NONE || !RemoveFromNode(Root, Height, Key))
+			{
+				return 0;
+			}
+
+			NumElements--;
+
+			// The children of the root merged into one, it becomes the new root
+			if (Height > 0 && Inners[Root].NumKeys == 0)
+			{
+				const int32 OldRoot = Root;
+				Root = Inners[OldRoot].Children[0];
+				FreeInner(OldRoot);
+				Height--;
+			}
+			return 1;
+		}
+
+		/**
+		* Finds an element with the given key in the set.
+		* @return A pointer to an element with the given key, or nullptr if the set doesn't contain it. The pointer is
+		*			only valid until the next change to the set.
+		*/
+		ElementType* Find(KeyInitType Key)
+		{
+			if (Root == INDEX_NONE)
+			{
+				return nullptr;
+			}
+
+			LeafNode& Leaf = Leaves[FindLeaf(Key)];
+			const int32 Pos = LeafLowerBound(Leaf, Key);
+			ElementType* Element = GetElements(Leaf) + Pos;
+			return Pos < Leaf.NumElements && !KeyFuncs::Less(Key, KeyFuncs::GetSetKey(*Element)) ? Element : nullptr;
+		}
+		__forceinline const ElementType* Find(KeyInitType Key) const
+		{
+			return const_cast<BTreeSet*>(this)->Find(Key);
+		}
+
+		__forceinline bool Contains(KeyInitType Key) const
+		{
+			return Find(Key) != nullptr;
+		}
+
+		/** @return The number of elements. */
+		__forceinline int32 Size() const
+		{
+			return NumElements;
+		}
+
+		/** Removes all the elements, freeing the nodes. */
+		void Clear()
+		{
+			DestructNodes();
+			Leaves.Clear();
+			Inners.Clear();
+			ResetRoot();
+		}
+
+		/** Removes all the elements, keeping the node memory for elements about to be added. */
+		void Reset()
+		{
+			DestructNodes();
+			Leaves.Reset();
+			Inners.Reset();
+			ResetRoot();
+		}
+
+		/** Preallocates nodes for the given number of elements added in any order. */
+		void Reserve(int32 Number)
+		{
+			const int32 NumLeaves = Number / MinLeafElements + 1;
+			Leaves.Reserve(NumLeaves);
+			Inners.Reserve(NumLeaves / MinInnerKeys + 1);
+		}
+
+		__forceinline uint32 GetAllocatedSize() const
+		{
+			return Leaves.GetAllocatedSize() + Inners.GetAllocatedSize();
+		}
+
+		/** In key order iterator, walks the linked leaves. */
+		template<bool bConst>
+		class BaseIterator
+		{
+		protected:
+			typedef typename ChooseClass<bConst, const BTreeSet, BTreeSet>::Result SetType;
+			typedef typename ChooseClass<bConst, const ElementType, ElementType>::Result ItElementType;
+
+		public:
+			__forceinline explicit BaseIterator(SetType& InSet)
+				: TheSet(InSet)
+				, LeafIndex(InSet.NumElements > 0 ? InSet.FirstLeaf : INDEX_NONE)
+				, Pos(0)
+			{
+			}
+
+			__forceinline BaseIterator(SetType& InSet, int32 InLeafIndex, int32 InPos)
+				: TheSet(InSet)
+				, LeafIndex(InLeafIndex)
+				, Pos(InPos)
+			{
+				// A position past the last element of a leaf is the first element of the next one
+				if (LeafIndex != INDEX_NONE && Pos == TheSet.Leaves[LeafIndex].NumElements)
+				{
+					LeafIndex = TheSet.Leaves[LeafIndex].Next;
+					Pos = 0;
+				}
+			}
+
+			__forceinline BaseIterator& operator++()
+			{
+				const LeafNode& Leaf = TheSet.Leaves[LeafIndex];
+				if (++Pos == Leaf.NumElements)
+				{
+					LeafIndex = Leaf.Next;
+					Pos = 0;
+				}
+				return *this;
+			}
+
+			/** Moves to the previous element, the iterator is invalid once it moved past the first one. */
+			__forceinline BaseIterator& operator--()
+			{
+				if (Pos > 0)
+				{
+					--Pos;
+				}
+				else
+				{
+					LeafIndex = TheSet.Leaves[LeafIndex].Prev;
+					Pos = LeafIndex != INDEX_NONE ? TheSet.Leaves[LeafIndex].NumElements - 1 : 0;
+				}
+				return *this;
+			}
+
+			/** conversion to "bool" returning true if the iterator is valid. */
+			__forceinline explicit operator bool() const
+			{
+				return LeafIndex != INDEX_NONE;
+			}
+			/** inverse of the "bool" operator */
+			__forceinline bool operator !() const
+			{
+				return LeafIndex == INDEX_NONE;
+			}
+
+			__forceinline friend bool operator==(const BaseIterator& Lhs, const BaseIterator& Rhs) { return &Lhs.TheSet == &Rhs.TheSet && Lhs.LeafIndex == Rhs.LeafIndex && Lhs.Pos == Rhs.Pos; }
+			__forceinline friend bool operator!=(const BaseIterator& Lhs, const BaseIterator& Rhs) { return &Lhs.TheSet != &Rhs.TheSet || Lhs.LeafIndex != Rhs.LeafIndex || Lhs.Pos != Rhs.Pos; }
+
+			__forceinline ItElementType& operator*() const
+			{
+				return BTreeSet::GetElements(TheSet.Leaves[LeafIndex])[Pos];
+			}
+			__forceinline ItElementType* operator->() const
+			{
+				return BTreeSet::GetElements(TheSet.Leaves[LeafIndex]) + Pos;
+			}
+
+		protected:
+			SetType& TheSet;
+			int32 LeafIndex;
+			int32 Pos;
+		};
+
+		typedef BaseIterator<false> Iterator;
+		typedef BaseIterator<true>  ConstIterator;
+
+		/** @return An iterator to the element with the smallest key. */
+		__forceinline Iterator CreateIterator()
+		{
+			return Iterator(*this);
+		}
+		__forceinline ConstIterator CreateConstIterator() const
+		{
+			return ConstIterator(*this);
+		}
+
+		/** @return An iterator to the first element whose key is not less than Key. */
+		__forceinline Iterator LowerBound(KeyInitType Key)
+		{
+			return Root != INDEX_NONE ? LowerBoundImpl<Iterator>(*this, Key) : Iterator(*this, INDEX_NONE, 0);
+		}
+		__forceinline ConstIterator LowerBound(KeyInitType Key) const
+		{
+			return Root != INDEX_NONE ? LowerBoundImpl<ConstIterator>(*this, Key) : ConstIterator(*this, INDEX_NONE, 0);
+		}
+
+		/** @return An iterator to the first element whose key is greater than Key. */
+		__forceinline Iterator UpperBound(KeyInitType Key)
+		{
+			return Root != INDEX_NONE ? UpperBoundImpl<Iterator>(*this, Key) : Iterator(*this, INDEX_NONE, 0);
+		}
+		__forceinline ConstIterator UpperBound(KeyInitType Key) const
+		{
+			return Root != INDEX_NONE ? UpperBoundImpl<ConstIterator>(*this, Key) : ConstIterator(*this, INDEX_NONE, 0);
+		}
+
+		/**
+		* Calls Func(Element) for every element with First <= Key < Last, in key order.
+		* @return The number of elements visited.
+		*/
+		template<typename FuncType>
+		int32 ForEachInRange(KeyInitType First, KeyInitType Last, FuncType Func) const
+		{
+			int32 NumVisited = 0;
+			for (ConstIterator It = LowerBound(First); It && KeyFuncs::Less(KeyFuncs::GetSetKey(*It), Last); ++It)
+			{
+				Func(*It);
+				NumVisited++;
+			}
+			return NumVisited;
+		}
+
+		/**
+		* DO NOT USE DIRECTLY
+		* STL-like iterators to enable range-based for loop support.
+		*/
+		__forceinline friend Iterator      begin(BTreeSet& Set) { return Iterator(Set); }
+		__forceinline friend ConstIterator begin(const BTreeSet& Set) { return ConstIterator(Set); }
+		__forceinline friend Iterator      end(BTreeSet& Set) { return Iterator(Set, INDEX_NONE, 0); }
+		__forceinline friend ConstIterator end(const BTreeSet& Set) { return ConstIterator(Set, INDEX_NONE, 0); }
+
+	private:
+		static __forceinline ElementType* GetElements(LeafNode& Leaf)
+		{
+			return (ElementType*)Leaf.Elements;
+		}
+		static __forceinline const ElementType* GetElements(const LeafNode& Leaf)
+		{
+			return (const ElementType*)Leaf.Elements;
+		}
+		static __forceinline KeyType* GetKeys(InnerNode& Node)
+		{
+			return (KeyType*)Node.Keys;
+		}
+		static __forceinline const KeyType* GetKeys(const InnerNode& Node)
+		{
+			return (const KeyType*)Node.Keys;
+		}
+
+		/** @return The position of the first element of Leaf whose key isn't less than Key. */
+		static int32 LeafLowerBound(const LeafNode& Leaf, KeyInitType Key)
+		{
+			const ElementType* Elements = GetElements(Leaf);
+
+			int32 First = 0;
+			int32 Count = Leaf.NumElements;
+			while (Count > 0)
+			{
+				const int32 Step = Count / 2;
+				if (KeyFuncs::Less(KeyFuncs::GetSetKey(Elements[First + Step]), Key))
+				{
+					First += Step + 1;
+					Count -= Step + 1;
+				}
+				else
+				{
+					Count = Step;
+				}
+			}
+			return First;
+		}
+
+		/** @return The position of the first element of Leaf whose key is greater than Key. */
+		static int32 LeafUpperBound(const LeafNode& Leaf, KeyInitType Key)
+		{
+			const ElementType* Elements = GetElements(Leaf);
+
+			int32 First = 0;
+			int32 Count = Leaf.NumElements;
+			while (Count > 0)
+			{
+				const int32 Step = Count / 2;
+				if (!KeyFuncs::Less(Key, KeyFuncs::GetSetKey(Elements[First + Step])))
+				{
+					First += Step + 1;
+					Count -= Step + 1;
+				}
+				else
+				{
+					Count = Step;
+				}
+			}
+			return First;
+		}
+
+		/** @return The position of the child of Node whose range contains Key, the number of separators not greater than Key. */
+		static int32 ChildPosition(const InnerNode& Node, KeyInitType Key)
+		{
+			const KeyType* Keys = GetKeys(Node);
+
+			int32 First = 0;
+			int32 Count = Node.NumKeys;
+			while (Count > 0)
+			{
+				const int32 Step = Count / 2;
+				if (!KeyFuncs::Less(Key, Keys[First + Step]))
+				{
+					First += Step + 1;
+					Count -= Step + 1;
+				}
+				else
+				{
+					Count = Step;
+				}
+			}
+			return First;
+		}
+
+		/** @return The leaf whose range contains Key. The tree must not be empty. */
+		int32 FindLeaf(KeyInitType Key) const
+		{
+			int32 NodeIndex = Root;
+			for (int32 Level = Height; Level > 0; --Level)
+			{
+				const InnerNode& Node = Inners[NodeIndex];
+				NodeIndex = Node.Children[ChildPosition(Node, Key)];
+			}
+			return NodeIndex;
+		}
+
+		template<typename IteratorType, typename SetType>
+		static __forceinline IteratorType LowerBoundImpl(SetType& TheSet, KeyInitType Key)
+		{
+			// Keys of the following leaves aren't less than the separator above this one, so if every key here is less
+			// than Key, the first element of the next leaf is the bound
+			const int32 LeafIndex = TheSet.FindLeaf(Key);
+			return IteratorType(TheSet, LeafIndex, LeafLowerBound(TheSet.Leaves[LeafIndex], Key));
+		}
+
+		template<typename IteratorType, typename SetType>
+		static __forceinline IteratorType UpperBoundImpl(SetType& TheSet, KeyInitType Key)
+		{
+			const int32 LeafIndex = TheSet.FindLeaf(Key);
+			return IteratorType(TheSet, LeafIndex, LeafUpperBound(TheSet.Leaves[LeafIndex], Key));
+		}
+
+		template<typename ArgsType>
+		ElementType& EmplaceByKey(KeyInitType Key, ArgsType&& Args, bool* bIsAlreadyInSetPtr)
+		{
+			if (Root == INDEX_NONE)
+			{
+				Root = AllocLeaf();
+				FirstLeaf = Root;
+				Height = 0;
+			}
+
+			bool bIsAlreadyInSet = false;
+			SplitResult Split;
+			ElementType* Element = InsertIntoNode(Root, Height, Key, Forward<ArgsType>(Args), bIsAlreadyInSet, Split);
+
+			if (Split.RightNode != INDEX_NONE)
+			{
+				// The root split, grow the tree by one level
+				const int32 NewRoot = AllocInner();
+				InnerNode& Node = Inners[NewRoot];
+				Node.NumKeys = 1;
+				Node.Children[0] = Root;
+				Node.Children[1] = Split.RightNode;
+				RelocateConstructItems<KeyType>(GetKeys(Node), (KeyType*)&Split.Separator, 1);
+
+				Root = NewRoot;
+				Height++;
+			}
+
+			if (bIsAlreadyInSetPtr)
+			{
+				*bIsAlreadyInSetPtr = bIsAlreadyInSet;
+			}
+			return *Element;
+		}
+
+		/** Inserts into the subtree of NodeIndex, which is at Level above the leaves. Splits of the node are returned in OutSplit. */
+		template<typename ArgsType>
+		ElementType* InsertIntoNode(int32 NodeIndex, int32 Level, KeyInitType Key, ArgsType&& Args, bool& bIsAlreadyInSet, SplitResult& OutSplit)
+		{
+			if (Level == 0)
+			{
+				return InsertIntoLeaf(NodeIndex, Key, Forward<ArgsType>(Args), bIsAlreadyInSet, OutSplit);
+			}
+
+			const int32 Pos = ChildPosition(Inners[NodeIndex], Key);
+
+			SplitResult ChildSplit;
+			ElementType* Element = InsertIntoNode(Inners[NodeIndex].Children[Pos], Level - 1, Key, Forward<ArgsType>(Args), bIsAlreadyInSet, ChildSplit);
+
+			if (ChildSplit.RightNode != INDEX_NONE)
+			{
+				InsertIntoInner(NodeIndex, Pos, ChildSplit, OutSplit);
+			}
+			return Element;
+		}
+
+		template<typename ArgsType>
+		ElementType* InsertIntoLeaf(int32 LeafIndex, KeyInitType Key, ArgsType&& Args, bool& bIsAlreadyInSet, SplitResult& OutSplit)
+		{
+			LeafNode* Leaf = &Leaves[LeafIndex];
+			int32 Pos = LeafLowerBound(*Leaf, Key);
+
+			// Args may refer to elements of the set, which are replaced, shifted or moved to a new leaf below, build the
+			// new element aside first. Key may refer to Args, only the key of the new element is used from here on.
+			TypeCompatibleBytes<ElementType> NewElementBytes;
+			ElementType& NewElement = *new(&NewElementBytes) ElementType(Forward<ArgsType>(Args));
+
+			ElementType* Elements = GetElements(*Leaf);
+			if (Pos < Leaf->NumElements && !KeyFuncs::Less(KeyFuncs::GetSetKey(NewElement), KeyFuncs::GetSetKey(Elements[Pos])))
+			{
+				bIsAlreadyInSet = true;
+
+				MoveByRelocate(Elements[Pos], NewElement);
+				return Elements + Pos;
+			}
+
+			if (Leaf->NumElements == LeafCapacity)
+			{
+				const int32 RightIndex = AllocLeaf();
+				Leaf = &Leaves[LeafIndex];
+
+				LeafNode& Right = Leaves[RightIndex];
+				Right.Prev = LeafIndex;
+				Right.Next = Leaf->Next;
+				if (Leaf->Next != INDEX_NONE)
+				{
+					Leaves[Leaf->Next].Prev = RightIndex;
+				}
+				Leaf->Next = RightIndex;
+
+				OutSplit.RightNode = RightIndex;
+
+				if (Pos == LeafCapacity && Right.Next == INDEX_NONE)
+				{
+					// Appending past the largest key, start a new leaf and leave this one full, so that ascending
+					// insertions build full leaves
+					new(&OutSplit.Separator) KeyType(KeyFuncs::GetSetKey(NewElement));
+					Leaf = &Right;
+					Pos = 0;
+				}
+				else
+				{
+					const int32 Mid = (LeafCapacity + 1) / 2;
+					Right.NumElements = LeafCapacity - Mid;
+					RelocateConstructItems<ElementType>(GetElements(Right), GetElements(*Leaf) + Mid, Right.NumElements);
+					Leaf->NumElements = Mid;
+
+					new(&OutSplit.Separator) KeyType(KeyFuncs::GetSetKey(*GetElements(Right)));
+
+					// An element going right of the last one kept here stays in this leaf, the separator remains the smallest key on the right
+					if (Pos > Mid)
+					{
+						Leaf = &Right;
+						Pos -= Mid;
+					}
+				}
+				Elements = GetElements(*Leaf);
+			}
+
+			RelocateConstructItems<ElementType>(Elements + Pos + 1, Elements + Pos, Leaf->NumElements - Pos);
+			RelocateConstructItems<ElementType>(Elements + Pos, &NewElement, 1);
+
+			Leaf->NumElements++;
+			NumElements++;
+			return Elements + Pos;
+		}
+
+		/** Adds the node split off child Pos of NodeIndex next to it, splitting NodeIndex in turn if it is full. */
+		void InsertIntoInner(int32 NodeIndex, int32 Pos, SplitResult& ChildSplit, SplitResult& OutSplit)
+		{
+			if (Inners[NodeIndex].NumKeys < InnerCapacity)
+			{
+				InsertInnerEntry(Inners[NodeIndex], Pos, ChildSplit);
+				return;
+			}
+
+			const int32 RightIndex = AllocInner();
+			InnerNode& Node = Inners[NodeIndex];
+			InnerNode& Right = Inners[RightIndex];
+
+			// The keys above Mid and their children go right, the key at Mid goes up
+			const int32 Mid = InnerCapacity / 2;
+			Right.NumKeys = InnerCapacity - Mid - 1;
+			RelocateConstructItems<KeyType>(GetKeys(Right), GetKeys(Node) + Mid + 1, Right.NumKeys);
+			Memory::Memcpy(Right.Children, Node.Children + Mid + 1, (Right.NumKeys + 1) * sizeof(int32));
+			RelocateConstructItems<KeyType>(&OutSplit.Separator, GetKeys(Node) + Mid, 1);
+			Node.NumKeys = Mid;
+
+			OutSplit.RightNode = RightIndex;
+
+			if (Pos <= Mid)
+			{
+				InsertInnerEntry(Node, Pos, ChildSplit);
+			}
+			else
+			{
+				InsertInnerEntry(Right, Pos - Mid - 1, ChildSplit);
+			}
+		}
+
+		/** Inserts the separator of Split at Pos of Node, and its right node as child Pos + 1. Node must not be full. */
+		static void InsertInnerEntry(InnerNode& Node, int32 Pos, SplitResult& Split)
+		{
+			KeyType* Keys = GetKeys(Node);
+			RelocateConstructItems<KeyType>(Keys + Pos + 1, Keys + Pos, Node.NumKeys - Pos);
+			Memory::Memmove(Node.Children + Pos + 2, Node.Children + Pos + 1, (Node.NumKeys - Pos) * sizeof(int32));
+
+			RelocateConstructItems<KeyType>(Keys + Pos, (KeyType*)&Split.Separator, 1);
+			Node.Children[Pos + 1] = Split.RightNode;
+			Node.NumKeys++;
+		}
+
+		/** Removes separator Pos and child Pos + 1 of Node. The separator must have been destructed or relocated already. */
+		static void RemoveInnerEntry(InnerNode& Node, int32 Pos)
+		{
+			KeyType* Keys = GetKeys(Node);
+			RelocateConstructItems<KeyType>(Keys + Pos, Keys + Pos + 1, Node.NumKeys - Pos - 1);
+			Memory::Memmove(Node.Children + Pos + 1, Node.Children + Pos + 2, (Node.NumKeys - Pos - 1) * sizeof(int32));
+			Node.NumKeys--;
+		}
+
+		static __forceinline void ReplaceKey(InnerNode& Node, int32 Pos, KeyInitType NewKey)
+		{
+			KeyType* Key = GetKeys(Node) + Pos;
+			DestructItems(Key, 1);
+			new(Key) KeyType(NewKey);
+		}
+
+		/** Removes Key from the subtree of NodeIndex, which is at Level above the leaves, refilling the nodes left less than half full. */
+		bool RemoveFromNode(int32 NodeIndex, int32 Level, KeyInitType Key)
+		{
+			if (Level == 0)
+			{
+				LeafNode& Leaf = Leaves[NodeIndex];
+				const int32 Pos = LeafLowerBound(Leaf, Key);
+
+				ElementType* Elements = GetElements(Leaf);
+				if (Pos == Leaf.NumElements || KeyFuncs::Less(Key, KeyFuncs::GetSetKey(Elements[Pos])))
+				{
+					return false;
+				}
+
+				// Separators above may still hold the removed key, they keep separating the same ranges
+				DestructItems(Elements + Pos, 1);
+				RelocateConstructItems<ElementType>(Elements + Pos, Elements + Pos + 1, Leaf.NumElements - Pos - 1);
+				Leaf.NumElements--;
+				return true;
+			}
+
+			const int32 Pos = ChildPosition(Inners[NodeIndex], Key);
+			if (!RemoveFromNode(Inners[NodeIndex].Children[Pos], Level - 1, Key))
+			{
+				return false;
+			}
+
+			// Only nodes are freed below, references to nodes stay valid
+			InnerNode& Node = Inners[NodeIndex];
+			if (Level == 1)
+			{
+				RefillLeaf(Node, Pos);
+			}
+			else
+			{
+				RefillInner(Node, Pos);
+			}
+			return true;
+		}
+
+		/** Refills leaf child Pos of Parent with an element of a sibling, or merges it with one, if it is less than half full. */
+		void RefillLeaf(InnerNode& Parent, int32 Pos)
+		{
+			LeafNode& Child = Leaves[Parent.Children[Pos]];
+			if (Child.NumElements >= MinLeafElements)
+			{
+				return;
+			}
+
+			ElementType* ChildElements = GetElements(Child);
+			if (Pos > 0)
+			{
+				LeafNode& Left = Leaves[Parent.Children[Pos - 1]];
+				if (Left.NumElements > MinLeafElements)
+				{
+					RelocateConstructItems<ElementType>(ChildElements + 1, ChildElements, Child.NumElements);
+					RelocateConstructItems<ElementType>(ChildElements, GetElements(Left) + Left.NumElements - 1, 1);
+					Left.NumElements--;
+					Child.NumElements++;
+
+					ReplaceKey(Parent, Pos - 1, KeyFuncs::GetSetKey(ChildElements[0]));
+					return;
+				}
+			}
+
+			if (Pos < Parent.NumKeys)
+			{
+				LeafNode& Right = Leaves[Parent.Children[Pos + 1]];
+				if (Right.NumElements > MinLeafElements)
+				{
+					ElementType* RightElements = GetElements(Right);
+					RelocateConstructItems<ElementType>(ChildElements + Child.NumElements, RightElements, 1);
+					RelocateConstructItems<ElementType>(RightElements, RightElements + 1, Right.NumElements - 1);
+					Right.NumElements--;
+					Child.NumElements++;
+
+					ReplaceKey(Parent, Pos, KeyFuncs::GetSetKey(RightElements[0]));
+					return;
+				}
+			}
+
+			if (Pos > 0)
+			{
+				MergeLeaves(Parent, Pos - 1);
+			}
+			else if (Pos < Parent.NumKeys)
+			{
+				MergeLeaves(Parent, Pos);
+			}
+		}
+
+		/** Moves the elements of leaf child Pos + 1 of Parent into child Pos and frees it. */
+		void MergeLeaves(InnerNode& Parent, int32 Pos)
+		{
+			const int32 LeftIndex = Parent.Children[Pos];
+			const int32 RightIndex = Parent.Children[Pos + 1];
+			LeafNode& Left = Leaves[LeftIndex];
+			LeafNode& Right = Leaves[RightIndex];
+
+			RelocateConstructItems<ElementType>(GetElements(Left) + Left.NumElements, GetElements(Right), Right.NumElements);
+			Left.NumElements += Right.NumElements;
+			Right.NumElements = 0;
+
+			Left.Next = Right.Next;
+			if (Right.Next != INDEX_NONE)
+			{
+				Leaves[Right.Next].Prev = LeftIndex;
+			}
+			FreeLeaf(RightIndex);
+
+			DestructItems(GetKeys(Parent) + Pos, 1);
+			RemoveInnerEntry(Parent, Pos);
+		}
+
+		/** Rotates a key through Parent from a sibling of inner child Pos, or merges it with one, if it is less than half full. */
+		void RefillInner(InnerNode& Parent, int32 Pos)
+		{
+			InnerNode& Child = Inners[Parent.Children[Pos]];
+			if (Child.NumKeys >= MinInnerKeys)
+			{
+				return;
+			}
+
+			KeyType* ParentKeys = GetKeys(Parent);
+			KeyType* ChildKeys = GetKeys(Child);
+			if (Pos > 0)
+			{
+				InnerNode& Left = Inners[Parent.Children[Pos - 1]];
+				if (Left.NumKeys > MinInnerKeys)
+				{
+					// The separator comes down in front of the child, the last key of the left sibling goes up
+					RelocateConstructItems<KeyType>(ChildKeys + 1, ChildKeys, Child.NumKeys);
+					Memory::Memmove(Child.Children + 1, Child.Children, (Child.NumKeys + 1) * sizeof(int32));
+					RelocateConstructItems<KeyType>(ChildKeys, ParentKeys + Pos - 1, 1);
+					Child.Children[0] = Left.Children[Left.NumKeys];
+					Child.NumKeys++;
+
+					RelocateConstructItems<KeyType>(ParentKeys + Pos - 1, GetKeys(Left) + Left.NumKeys - 1, 1);
+					Left.NumKeys--;
+					return;
+				}
+			}
+
+			if (Pos < Parent.NumKeys)
+			{
+				InnerNode& Right = Inners[Parent.Children[Pos + 1]];
+				if (Right.NumKeys > MinInnerKeys)
+				{
+					KeyType* RightKeys = GetKeys(Right);
+					RelocateConstructItems<KeyType>(ChildKeys + Child.NumKeys, ParentKeys + Pos, 1);
+					Child.Children[Child.NumKeys + 1] = Right.Children[0];
+					Child.NumKeys++;
+
+					RelocateConstructItems<KeyType>(ParentKeys + Pos, RightKeys, 1);
+					RelocateConstructItems<KeyType>(RightKeys, RightKeys + 1, Right.NumKeys - 1);
+					Memory::Memmove(Right.Children, Right.Children + 1, Right.NumKeys * sizeof(int32));
+					Right.NumKeys--;
+					return;
+				}
+			}
+
+			if (Pos > 0)
+			{
+				MergeInners(Parent, Pos - 1);
+			}
+			else if (Pos < Parent.NumKeys)
+			{
+				MergeInners(Parent, Pos);
+			}
+		}
+
+		/** Moves separator Pos of Parent and the content of inner child Pos + 1 into child Pos, and frees child Pos + 1. */
+		void MergeInners(InnerNode& Parent, int32 Pos)
+		{
+			const int32 RightIndex = Parent.Children[Pos + 1];
+			InnerNode& Left = Inners[Parent.Children[Pos]];
+			InnerNode& Right = Inners[RightIndex];
+
+			KeyType* LeftKeys = GetKeys(Left);
+			RelocateConstructItems<KeyType>(LeftKeys + Left.NumKeys, GetKeys(Parent) + Pos, 1);
+			RelocateConstructItems<KeyType>(LeftKeys + Left.NumKeys + 1, GetKeys(Right), Right.NumKeys);
+			Memory::Memcpy(Left.Children + Left.NumKeys + 1, Right.Children, (Right.NumKeys + 1) * sizeof(int32));
+			Left.NumKeys += Right.NumKeys + 1;
+
+			Right.NumKeys = 0;
+			FreeInner(RightIndex);
+
+			RemoveInnerEntry(Parent, Pos);
+		}
+
+		/**
+		* Replaces the content of the set with Num elements sorted by key, ConstructNext(Dest) constructing the next
+		* one at Dest. Leaves are filled completely, the inner levels have their children spread evenly.
+		*/
+		template<typename ConstructFuncType>
+		void BuildSortedImpl(int32 Num, const ConstructFuncType& ConstructNext)
+		{
+			Reset();
+			if (Num == 0)
+			{
+				return;
+			}
+
+			Leaves.Reserve((Num + LeafCapacity - 1) / LeafCapacity);
+
+			int32 LeafIndex = AllocLeaf();
+			FirstLeaf = LeafIndex;
+
+			ElementType* Previous = nullptr;
+			for (int32 i = 0; i < Num; i++)
+			{
+				LeafNode* Leaf = &Leaves[LeafIndex];
+				ElementType* Dest = GetElements(*Leaf) + Leaf->NumElements;
+				ConstructNext(Dest);
+
+				if (Previous)
+				{
+					Assertf(!KeyFuncs::Less(KeyFuncs::GetSetKey(*Dest), KeyFuncs::GetSetKey(*Previous)), EDX_TEXT("BTreeSet::BuildFromSorted input must be sorted"));
+
+					// Equal keys, the later element replaces the earlier one
+					if (!KeyFuncs::Less(KeyFuncs::GetSetKey(*Previous), KeyFuncs::GetSetKey(*Dest)))
+					{
+						MoveByRelocate(*Previous, *Dest);
+						continue;
+					}
+				}
+
+				Previous = Dest;
+				NumElements++;
+
+				if (++Leaf->NumElements == LeafCapacity && i + 1 < Num)
+				{
+					// The leaves were reserved, pointers to elements stay valid
+					const int32 NextIndex = AllocLeaf();
+					Leaves[NextIndex].Prev = LeafIndex;
+					Leaves[LeafIndex].Next = NextIndex;
+					LeafIndex = NextIndex;
+				}
+			}
+
+			// Duplicates may have left the last leaf empty, or less than half full, take elements from the previous one
+			LeafNode& LastLeaf = Leaves[LeafIndex];
+			if (LastLeaf.NumElements < MinLeafElements && LastLeaf.Prev != INDEX_NONE)
+			{
+				LeafNode& PrevLeaf = Leaves[LastLeaf.Prev];
+				const int32 NumMoved = MinLeafElements - LastLeaf.NumElements;
+
+				ElementType* LastElements = GetElements(LastLeaf);
+				RelocateConstructItems<ElementType>(LastElements + NumMoved, LastElements, LastLeaf.NumElements);
+				RelocateConstructItems<ElementType>(LastElements, GetElements(PrevLeaf) + PrevLeaf.NumElements - NumMoved, NumMoved);
+				PrevLeaf.NumElements -= NumMoved;
+				LastLeaf.NumElements += NumMoved;
+			}
+
+			// Nodes of the level being built and the first leaf of their subtrees, for the separators
+			Array<int32> Level;
+			Array<int32> LevelFirstLeaf;
+			for (int32 Index = FirstLeaf; Index != INDEX_NONE; Index = Leaves[Index].Next)
+			{
+				Level.Add(Index);
+			}
+			LevelFirstLeaf = Level;
+
+			while (Level.Size() > 1)
+			{
+				const int32 NumChildren = Level.Size();
+				const int32 NumParents = (NumChildren + InnerCapacity) / (InnerCapacity + 1);
+				Inners.Reserve(Inners.Size() + NumParents);
+
+				Array<int32> ParentLevel;
+				Array<int32> ParentFirstLeaf;
+				int32 Child = 0;
+				for (int32 i = 0; i < NumParents; i++)
+				{
+					const int32 ParentIndex = AllocInner();
+					InnerNode& Parent = Inners[ParentIndex];
+
+					const int32 NumParentChildren = NumChildren / NumParents + (i < NumChildren % NumParents ? 1 : 0);
+					Parent.NumKeys = NumParentChildren - 1;
+					for (int32 j = 0; j < NumParentChildren; j++, Child++)
+					{
+						Parent.Children[j] = Level[Child];
+						if (j > 0)
+						{
+							new(GetKeys(Parent) + j - 1) KeyType(KeyFuncs::GetSetKey(*GetElements(Leaves[LevelFirstLeaf[Child]])));
+						}
+					}
+
+					ParentLevel.Add(ParentIndex);
+					ParentFirstLeaf.Add(LevelFirstLeaf[Child - NumParentChildren]);
+				}
+
+				Level = Move(ParentLevel);
+				LevelFirstLeaf = Move(ParentFirstLeaf);
+				Height++;
+			}
+
+			Root = Level[0];
+		}
+
+		int32 AllocLeaf()
+		{
+			int32 Index = FreeLeaves;
+			if (Index != INDEX_NONE)
+			{
+				FreeLeaves = Leaves[Index].Next;
+			}
+			else
+			{
+				Index = Leaves.AddUninitialized(1);
+			}
+
+			LeafNode& Leaf = Leaves[Index];
+			Leaf.NumElements = 0;
+			Leaf.Prev = INDEX_NONE;
+			Leaf.Next = INDEX_NONE;
+			return Index;
+		}
+
+		__forceinline void FreeLeaf(int32 Index)
+		{
+			Leaves[Index].Next = FreeLeaves;
+			FreeLeaves = Index;
+		}
+
+		int32 AllocInner()
+		{
+			int32 Index = FreeInners;
+			if (Index != INDEX_NONE)
+			{
+				FreeInners = Inners[Index].Children[0];
+			}
+			else
+			{
+				Index = Inners.AddUninitialized(1);
+			}
+
+			Inners[Index].NumKeys = 0;
+			return Index;
+		}
+
+		__forceinline void FreeInner(int32 Index)
+		{
+			Inners[Index].Children[0] = FreeInners;
+			FreeInners = Index;
+		}
+
+		/** Destructs the elements and the separator keys, the nodes are left as they are. */
+		void DestructNodes()
+		{
+			if (Root == INDEX_NONE)
+			{
+				return;
+			}
+
+			if (TypeTraits<ElementType>::NeedsDestructor)
+			{
+				for (int32 Index = FirstLeaf; Index != INDEX_NONE; Index = Leaves[Index].Next)
+				{
+					DestructItems(GetElements(Leaves[Index]), Leaves[Index].NumElements);
+				}
+			}
+
+			if (TypeTraits<KeyType>::NeedsDestructor && Height > 0)
+			{
+				DestructKeys(Root, Height);
+			}
+		}
+
+		void DestructKeys(int32 NodeIndex, int32 Level)
+		{
+			InnerNode& Node = Inners[NodeIndex];
+			DestructItems(GetKeys(Node), Node.NumKeys);
+
+			if (Level > 1)
+			{
+				for (int32 i = 0; i <= Node.NumKeys; i++)
+				{
+					DestructKeys(Node.Children[i], Level - 1);
+				}
+			}
+		}
+
+		void ResetRoot()
+		{
+			NumElements = 0;
+			Root = INDEX_NONE;
+			Height = 0;
+			FirstLeaf = INDEX_NONE;
+			FreeLeaves = INDEX_NONE;
+			FreeInners = INDEX_NONE;
+		}
+
+		Array<LeafNode, Allocator> Leaves;
+		Array<InnerNode, Allocator> Inners;
+
+		int32 NumElements;
+
+		/** Root node, a leaf when Height is 0. INDEX_NONE until the first element is added. */
+		int32 Root;
+		int32 Height;
+
+		int32 FirstLeaf;
+		int32 FreeLeaves;
+		int32 FreeInners;
+	};
+
+	/**
+	* Ordered map, a BTreeSet of key-value pairs. See BTreeSet.
+	*/
+	template<typename KeyType, typename ValueType, typename Allocator = AlignedHeapAllocator<BTree_Private::CacheLineBytes>>
+	class BTreeMap
+	{
+	public:
+		typedef typename TypeTraits<KeyType  >::ConstInitType KeyInitType;
+		typedef typename TypeTraits<ValueType>::ConstInitType ValueInitType;
+		typedef Pair<KeyType, ValueType> ElementType;
+
+	private:
+		typedef BTreeSet<ElementType, BTreeMapKeyFuncs<KeyType, ValueType>, Allocator> PairSetType;
+
+	public:
+		BTreeMap() = default;
+		BTreeMap(BTreeMap&&) = default;
+		BTreeMap(const BTreeMap&) = default;
+		BTreeMap& operator=(BTreeMap&&) = default;
+		BTreeMap& operator=(const BTreeMap&) = default;
+
+		/**
+		* Sets the value associated with a key.
+		*
+		* @return A reference to the value as stored in the map.  The reference is only valid until the next change to any key in the map.
+		*/
+		__forceinline ValueType& Add(const KeyType&  InKey, const ValueType&  InValue) { return Emplace(InKey, InValue); }
+		__forceinline ValueType& Add(const KeyType&  InKey, ValueType&& InValue) { return Emplace(InKey, Move(InValue)); }
+		__forceinline ValueType& Add(KeyType&& InKey, const ValueType&  InValue) { return Emplace(Move(InKey), InValue); }
+		__forceinline ValueType& Add(KeyType&& InKey, ValueType&& InValue) { return Emplace(Move(InKey), Move(InValue)); }
+
+		/**
+		* Sets a default value associated with a key.
+		*
+		* @return A reference to the value as stored in the map.  The reference is only valid until the next change to any key in the map.
+		*/
+		__forceinline ValueType& Add(const KeyType&  InKey) { return Emplace(InKey); }
+		__forceinline ValueType& Add(KeyType&& InKey) { return Emplace(Move(InKey)); }
+
+		template <typename InitKeyType, typename InitValueType>
+		ValueType& Emplace(InitKeyType&& InKey, InitValueType&& InValue)
+		{
+			return Pairs.EmplaceByKey(InKey, PairInitializer<InitKeyType&&, InitValueType&&>(Forward<InitKeyType>(InKey), Forward<InitValueType>(InValue)), nullptr).Value;
+		}
+
+		template <typename InitKeyType>
+		ValueType& Emplace(InitKeyType&& InKey)
+		{
+			return Pairs.EmplaceByKey(InKey, KeyInitializer<InitKeyType&&>(Forward<InitKeyType>(InKey)), nullptr).Value;
+		}
+
+		/**
+		* Replaces the content of the map with pairs sorted by key, see BTreeSet::BuildFromSorted. The last of
+		* adjacent pairs with equal keys is kept.
+		*/
+		template<typename ArrayAllocator>
+		void BuildFromSorted(Array<ElementType, ArrayAllocator>&& InPairs)
+		{
+			Pairs.BuildFromSorted(Move(InPairs));
+		}
+
+		/**
+		* Removes the value associated with a key.
+		* @return The number of values that were associated with the key, 0 or 1.
+		*/
+		__forceinline int32 Remove(KeyInitType InKey)
+		{
+			return Pairs.Remove(InKey);
+		}
+
+		/**
+		* Removes the pair with the specified key and copies the value that was removed to the ref parameter
+		* @return whether or not the key was found
+		*/
+		bool RemoveAndCopyValue(KeyInitType Key, ValueType& OutRemovedValue)
+		{
+			ValueType* Value = Find(Key);
+			if (!Value)
+			{
+				return false;
+			}
+
+			OutRemovedValue = Move(*Value);
+			Pairs.Remove(Key);
+			return true;
+		}
+
+		/**
+		* @return A pointer to the value associated with the specified key, or nullptr if the key isn't contained in this map.  The pointer
+		*			is only valid until the next change to any key in the map.
+		*/
+		__forceinline ValueType* Find(KeyInitType Key)
+		{
+			if (auto* Pair = Pairs.Find(Key))
+			{
+				return &Pair->Value;
+			}
+
+			return nullptr;
+		}
+		__forceinline const ValueType* Find(KeyInitType Key) const
+		{
+			return const_cast<BTreeMap*>(this)->Find(Key);
+		}
+
+		/** Returns the value associated with a specified key, or if none exists, adds a value using the default constructor. */
+		__forceinline ValueType& FindOrAdd(const KeyType&  Key) { return FindOrAddImpl(Key); }
+		__forceinline ValueType& FindOrAdd(KeyType&& Key) { return FindOrAddImpl(Move(Key)); }
+
+		/** @return The value associated with the specified key, or triggers an assertion if the key does not exist. */
+		__forceinline const ValueType& FindChecked(KeyInitType Key) const
+		{
+			const ValueType* Value = Find(Key);
+			Assert(Value != nullptr);
+			return *Value;
+		}
+		__forceinline ValueType& FindChecked(KeyInitType Key)
+		{
+			ValueType* Value = Find(Key);
+			Assert(Value != nullptr);
+			return *Value;
+		}
+
+		/** @return The value associated with the specified key, or the default value for the ValueType if the key isn't contained in this map. */
+		__forceinline ValueType FindRef(KeyInitType Key) const
+		{
+			const ValueType* Value = Find(Key);
+			return Value ? *Value : ValueType();
+		}
+
+		__forceinline bool Contains(KeyInitType Key) const
+		{
+			return Pairs.Contains(Key);
+		}
+
+		__forceinline ValueType& operator[](KeyInitType Key) { return FindChecked(Key); }
+		__forceinline const ValueType& operator[](KeyInitType Key) const { return FindChecked(Key); }
+
+		/**
+		* Calls Func(Key, Value) for every pair with First <= Key < Last, in key order.
+		* @return The number of pairs visited.
+		*/
+		template<typename FuncType>
+		int32 ForEachInRange(KeyInitType First, KeyInitType Last, FuncType Func) const
+		{
+			return Pairs.ForEachInRange(First, Last, [&Func](const ElementType& Pair)
+			{
+				Func(Pair.Key, Pair.Value);
+			});
+		}
+
+		/** Generates an array from the keys in this map, in key order. */
+		template<typename ArrayAllocator> void GenerateKeyArray(Array<KeyType, ArrayAllocator>& OutArray) const
+		{
+			OutArray.Clear(Pairs.Size());
+			for (const ElementType& Pair : Pairs)
+			{
+				new(OutArray) KeyType(Pair.Key);
+			}
+		}
+
+		/** Generates an array from the values in this map, in key order. */
+		template<typename ArrayAllocator> void GenerateValueArray(Array<ValueType, ArrayAllocator>& OutArray) const
+		{
+			OutArray.Clear(Pairs.Size());
+			for (const ElementType& Pair : Pairs)
+			{
+				new(OutArray) ValueType(Pair.Value);
+			}
+		}
+
+		__forceinline void Clear()
+		{
+			Pairs.Clear();
+		}
+
+		__forceinline void Reset()
+		{
+			Pairs.Reset();
+		}
+
+		__forceinline void Reserve(int32 Number)
+		{
+			Pairs.Reserve(Number);
+		}
+
+		__forceinline int32 Size() const
+		{
+			return Pairs.Size();
+		}
+
+		__forceinline uint32 GetAllocatedSize() const
+		{
+			return Pairs.GetAllocatedSize();
+		}
+
+		/** Map iterator, also gives access to the key and value of the current pair. */
+		class Iterator : public PairSetType::Iterator
+		{
+		public:
+			__forceinline explicit Iterator(BTreeMap& InMap)
+				: PairSetType::Iterator(InMap.Pairs)
+			{
+			}
+
+			__forceinline Iterator(const typename PairSetType::Iterator& InIterator)
+				: PairSetType::Iterator(InIterator)
+			{
+			}
+
+			__forceinline const KeyType& Key() const { return (*this)->Key; }
+			__forceinline ValueType& Value() const { return (*this)->Value; }
+		};
+
+		class ConstIterator : public PairSetType::ConstIterator
+		{
+		public:
+			__forceinline explicit ConstIterator(const BTreeMap& InMap)
+				: PairSetType::ConstIterator(InMap.Pairs)
+			{
+			}
+
+			__forceinline ConstIterator(const typename PairSetType::ConstIterator& InIterator)
+				: PairSetType::ConstIterator(InIterator)
+			{
+			}
+
+			__forceinline const KeyType& Key() const { return (*this)->Key; }
+			__forceinline const ValueType& Value() const { return (*this)->Value; }
+		};
+
+		/** @return An iterator to the pair with the smallest key. */
+		__forceinline Iterator CreateIterator()
+		{
+			return Iterator(*this);
+		}
+		__forceinline ConstIterator CreateConstIterator() const
+		{
+			return ConstIterator(*this);
+		}
+
+		/** @return An iterator to the first pair whose key is not less than Key. */
+		__forceinline Iterator LowerBound(KeyInitType Key) { return Iterator(Pairs.LowerBound(Key)); }
+		__forceinline ConstIterator LowerBound(KeyInitType Key) const { return ConstIterator(Pairs.LowerBound(Key)); }
+
+		/** @return An iterator to the first pair whose key is greater than Key. */
+		__forceinline Iterator UpperBound(KeyInitType Key) { return Iterator(Pairs.UpperBound(Key)); }
+		__forceinline ConstIterator UpperBound(KeyInitType Key) const { return ConstIterator(Pairs.UpperBound(Key)); }
+
+		/**
+		* DO NOT USE DIRECTLY
+		* STL-like iterators to enable range-based for loop support.
+		*/
+		__forceinline friend Iterator      begin(BTreeMap& Map) { return Iterator(Map); }
+		__forceinline friend ConstIterator begin(const BTreeMap& Map) { return ConstIterator(Map); }
+		__forceinline friend Iterator      end(BTreeMap& Map) { return Iterator(end(Map.Pairs)); }
+		__forceinline friend ConstIterator end(const BTreeMap& Map) { return ConstIterator(end(Map.Pairs)); }
+
+	private:
+		template <typename ArgType>
+		ValueType& FindOrAddImpl(ArgType&& Arg)
+		{
+			if (ValueType* Value = Find(Arg))
+			{
+				return *Value;
+			}
+
+			return Emplace(Forward<ArgType>(Arg));
+		}
+
+		PairSetType Pairs;
+	};
+}
@@ -15,6 +15,10 @@ namespace EDX
 
 		T* mpData;
 
+		LargePageMode mLargePageMode;
+		bool mbLargePages;
+		bool mbParallelFirstTouch;
+
 		uint mLogBlockElemCount;
 		uint mRoundedSize;
 		ArrayIndex<Dimension> mOrgIndex;
@@ -24,6 +28,9 @@ namespace EDX
 	public:
 		BlockedDimensionalArray()
 			: mpData(NULL)
+			, mLargePageMode(LargePageMode::Default)
+			, mbLargePages(false)
+			, mbParallelFirstTouch(false)
 		{
 		}
 		virtual ~BlockedDimensionalArray()
@@ -39,17 +46,21 @@ namespace EDX
 				Init(rhs.Size());
 			}
 
-			Memory::Memcpy(mpData, rhs.mpData, mRoundedSize * sizeof(T));
+			Memory::BulkMemcpy(mpData, rhs.mpData, SIZE_T(mRoundedSize) * sizeof(T), true);
 			return *this;
 		}
 		BlockedDimensionalArray& operator = (BlockedDimensionalArray&& rhs)
 		{
-			if (Size() != rhs.Size())
-			{
-				Free();
-				Init(rhs.Size());
-			}
+			Free();
+
+			mOrgIndex = rhs.mOrgIndex;
+			mBlockIndex = rhs.mBlockIndex;
+			mIntraBlockIndex = rhs.mIntraBlockIndex;
+			mRoundedSize = rhs.mRoundedSize;
+			mLogBlockElemCount = rhs.mLogBlockElemCount;
+
 			mpData = rhs.mpData;
+			mbLargePages = rhs.mbLargePages;
 			rhs.mpData = NULL;
 			return *this;
 		}
@@ -60,11 +71,11 @@ namespace EDX
 			Vec<Dimension, uint> roundUpSize = RoundUp(size);
 			mRoundedSize = roundUpSize.Product();
 
-			Memory::Free(mpData);
-			mpData = Memory::AlignedAlloc<T>(mRoundedSize);
+			Free();
+			mpData = (T*)VirtualMemory::AllocateBulk(SIZE_T(mRoundedSize) * sizeof(T), mLargePageMode, mbLargePages);
 			Assert(mpData);
 
-			if (bClear)
+			if (bClear || mbParallelFirstTouch)
 				Clear();
 
 			mBlockIndex.Init(roundUpSize >> LogBlockSize);
@@ -75,7 +86,31 @@ namespace EDX
 
 		__forceinline void Clear()
 		{
-			Memory::SafeClear(mpData, mRoundedSize);
+			if (mpData && mbParallelFirstTouch)
+				ParallelFirstTouchZero(mpData, mRoundedSize, sizeof(T));
+			else if (mpData)
+				Memory::BulkMemzero(mpData, SIZE_T(mRoundedSize) * sizeof(T), true);
+		}
+
+		/** Selects whether the following Init calls allocate from large pages, see DimensionalArray::SetLargePageMode. */
+		void SetLargePageMode(LargePageMode mode)
+		{
+			mLargePageMode = mode;
+		}
+
+		/** @return true if the current data is backed by large pages. */
+		bool UsesLargePages() const
+		{
+			return mbLargePages;
+		}
+
+		/**
+		* Makes Init and Clear zero the data in parallel with the static partition of the blocked storage, see
+		* DimensionalArray::SetParallelFirstTouch. Compute loops should iterate over the storage order to benefit.
+		*/
+		void SetParallelFirstTouch(bool bEnable)
+		{
+			mbParallelFirstTouch = bEnable;
 		}
 
 		void SetData(const T* pData)
@@ -127,7 +162,11 @@ namespace EDX
 
 		void Free()
 		{
-			Memory::Free(mpData);
+			if (mpData)
+			{
+				VirtualMemory::FreeBulk(mpData, mbLargePages);
+				mpData = NULL;
+			}
 		}
 
 	private:
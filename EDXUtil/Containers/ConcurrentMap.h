@@ -0,0 +1,350 @@
+#pragma once
+
+#include "../Core/Types.h"
+#include "../Core/Template.h"
+#include "../Core/Memory.h"
+#include "Map.h"
+#include "../Windows/Threading.h"
+
+#include <new>
+
+namespace EDX
+{
+	/**
+	* Thread safe hash map for shared caches, split into independently locked shards.
+	*
+	* Every shard is a Map behind its own RWLock, padded to its own cache lines. A key goes to the shard picked
+	* by the high bits of its mixed hash, while the shard's Map buckets by the low bits, and the hash is computed
+	* once per operation. Threads only contend when they hit the same shard, and readers of a shard don't block
+	* each other.
+	*
+	* Values are copied out, references into the map would not outlive the shard lock. Read and Update run a
+	* function on the value in place under the lock instead; such functions must not call back into the map.
+	* Each operation on a key is atomic, Size and ForEach visit the shards one after the other and are not a
+	* snapshot of the whole map.
+	*/
+	template<typename KeyType, typename ValueType, typename SetAllocator = DefaultSetAllocator, typename KeyFuncs = DefaultMapKeyFuncs<KeyType, ValueType, false>>
+	class ConcurrentMap
+	{
+		typedef Map<KeyType, ValueType, SetAllocator, KeyFuncs> MapType;
+		typedef typename KeyFuncs::KeyInitType KeyInitType;
+
+		struct Shard
+		{
+			RWLock Lock;
+			MapType Items;
+		};
+
+		enum { MaxDefaultShards = 256 };
+
+	public:
+		/**
+		* @param InNumShards	Number of shards, rounded up to a power of two. 0 uses four per logical processor,
+		*						so that two threads rarely work on the same shard.
+		*/
+		explicit ConcurrentMap(uint32 InNumShards = 0)
+		{
+			if (InNumShards == 0)
+			{
+				InNumShards = Math::Min(uint32(GetNumberOfCores()) * 4, uint32(MaxDefaultShards));
+			}
+			NumShards = Math::RoundUpPowOfTwo(Math::Max(InNumShards, 1u));
+
+			Shards = (CacheLinePadded<Shard>*)Memory::AlignedAlloc(NumShards * sizeof(CacheLinePadded<Shard>), PLATFORM_CACHE_LINE_SIZE);
+			for (uint32 i = 0; i < NumShards; i++)
+			{
+				new(Shards + i) CacheLinePadded<Shard>();
+			}
+		}
+
+		/** Must not race with any other access to the map. */
+		~ConcurrentMap()
+		{
+			DestructItems(Shards, int32(NumShards));
+			Memory::SafeFree(Shards);
+		}
+
+		/** Hidden on purpose, copying would have to lock every shard. */
+		ConcurrentMap(const ConcurrentMap&) = delete;
+		ConcurrentMap& operator=(const ConcurrentMap&) = delete;
+
+		/** Sets the value associated with a key, replacing the previous one. */
+		template <typename InitKeyType, typename InitValueType>
+		void Add(InitKeyType&& InKey, InitValueType&& InValue)
+		{
+			const uint32 KeyHash = KeyFuncs::GetKeyHash(InKey);
+			Shard& KeyShard = GetShard(KeyHash);
+
+			WriteScopeLock Lock(KeyShard.Lock);
+			KeyShard.Items.AddByHash(KeyHash, Forward<InitKeyType>(InKey), Forward<InitValueType>(InValue));
+		}
+
+		/**
+		* Copies the value associated with a key.
+		* @return true if the key was found, otherwise OutValue is left untouched
+		*/
+		bool Find(KeyInitType Key, ValueType& OutValue) const
+		{
+			const uint32 KeyHash = KeyFuncs::GetKeyHash(Key);
+			Shard& KeyShard = GetShard(KeyHash);
+
+			ReadScopeLock Lock(KeyShard.Lock);
+			if (const ValueType* Value = KeyShard.Items.FindByHash(KeyHash, Key))
+			{
+				OutValue = *Value;
+				return true;
+			}
+			return false;
+		}
+
+		/** @return A copy of the value associated with the specified key, or the default value for the ValueType if the key isn't contained in this map. */
+		ValueType FindRef(KeyInitType Key) const
+		{
+			ValueType Value = ValueType();
+			Find(Key, Value);
+			return Value;
+		}
+
+		bool Contains(KeyInitType Key) const
+		{
+			const uint32 KeyHash = KeyFuncs::GetKeyHash(Key);
+			Shard& KeyShard = GetShard(KeyHash);
+
+			ReadScopeLock Lock(KeyShard.Lock);
+			return KeyShard.Items.ContainsByHash(KeyHash, Key);
+		}
+
+		/**
+		* Calls Func(const ValueType&) with the value associated with a key, holding the shard lock for reading, for
+		* values that are expensive to copy.
+		* @return true if the key was found and Func called
+		*/
+		template<typename FuncType>
+		bool Read(KeyInitType Key, const FuncType& Func) const
+		{
+			const uint32 KeyHash = KeyFuncs::GetKeyHash(Key);
+			Shard& KeyShard = GetShard(KeyHash);
+
+			ReadScopeLock Lock(KeyShard.Lock);
+			if (const ValueType* Value = KeyShard.Items.FindByHash(KeyHash, Key))
+			{
+				Func(*Value);
+				return true;
+			}
+			return false;
+		}
+
+		/**
+		* Returns the value associated with a key, adding InValue first if there is none. Threads adding the same
+		* key concurrently all get the value of the one which added it.
+		*
+		* @param	bWasAddedPtr	[out]	Optional pointer to bool set to whether the value was added by this call
+		*/
+		ValueType FindOrAdd(const KeyType& Key, const ValueType& InValue, bool* bWasAddedPtr = nullptr)
+		{
+			return FindOrCreate(Key, [&InValue]() -> const ValueType& { return InValue; }, bWasAddedPtr);
+		}
+
+		/**
+		* Returns the value associated with a key, adding the value returned by MakeValue() if there is none. Hits
+		* only lock the shard for reading. On a miss MakeValue runs with the shard locked for writing, so it is
+		* called at most once per key however many threads ask for it at the same time.
+		*
+		* @param	bWasAddedPtr	[out]	Optional pointer to bool set to whether the value was added by this call
+		*/
+		template<typename FactoryType>
+		ValueType FindOrCreate(const KeyType& Key, const FactoryType& MakeValue, bool* bWasAddedPtr = nullptr)
+		{
+			const uint32 KeyHash = KeyFuncs::GetKeyHash(Key);
+			Shard& KeyShard = GetShard(KeyHash);
+
+			if (bWasAddedPtr)
+			{
+				*bWasAddedPtr = false;
+			}
+
+			{
+				ReadScopeLock Lock(KeyShard.Lock);
+				if (const ValueType* Existing = KeyShard.Items.FindByHash(KeyHash, Key))
+				{
+					return *Existing;
+				}
+			}
+
+			WriteScopeLock Lock(KeyShard.Lock);
+
+			// Another thread may have added the key between the two locks
+			if (const ValueType* Existing = KeyShard.Items.FindByHash(KeyHash, Key))
+			{
+				return *Existing;
+			}
+
+			if (bWasAddedPtr)
+			{
+				*bWasAddedPtr = true;
+			}
+			return KeyShard.Items.AddByHash(KeyHash, Key, MakeValue());
+		}
+
+		/**
+		* Calls Func(ValueType&) with the value associated with a key, holding the shard lock for writing, so that
+		* read-modify-write updates of the value are atomic.
+		* @return true if the key was found and Func called
+		*/
+		template<typename FuncType>
+		bool Update(KeyInitType Key, const FuncType& Func)
+		{
+			const uint32 KeyHash = KeyFuncs::GetKeyHash(Key);
+			Shard& KeyShard = GetShard(KeyHash);
+
+			WriteScopeLock Lock(KeyShard.Lock);
+			if (ValueType* Value = KeyShard.Items.FindByHash(KeyHash, Key))
+			{
+				Func(*Value);
+				return true;
+			}
+			return false;
+		}
+
+		/** Same as Update, a default constructed value is added first if the key isn't in the map. */
+		template<typename FuncType>
+		void UpdateOrAdd(const KeyType& Key, const FuncType& Func)
+		{
+			const uint32 KeyHash = KeyFuncs::GetKeyHash(Key);
+			Shard& KeyShard = GetShard(KeyHash);
+
+			WriteScopeLock Lock(KeyShard.Lock);
+			Func(KeyShard.Items.FindOrAddByHash(KeyHash, Key));
+		}
+
+		/**
+		* Removes the value associated with a key.
+		* @return The number of values that were associated with the key, 0 or 1.
+		*/
+		int32 Remove(KeyInitType Key)
+		{
+			const uint32 KeyHash = KeyFuncs::GetKeyHash(Key);
+			Shard& KeyShard = GetShard(KeyHash);
+
+			WriteScopeLock Lock(KeyShard.Lock);
+			return KeyShard.Items.RemoveByHash(KeyHash, Key);
+		}
+
+		/**
+		* Removes the pair with the specified key and moves the value that was removed to the ref parameter
+		* @return whether or not the key was found
+		*/
+		bool RemoveAndCopyValue(KeyInitType Key, ValueType& OutRemovedValue)
+		{
+			const uint32 KeyHash = KeyFuncs::GetKeyHash(Key);
+			Shard& KeyShard = GetShard(KeyHash);
+
+			WriteScopeLock Lock(KeyShard.Lock);
+			ValueType* Value = KeyShard.Items.FindByHash(KeyHash, Key);
+			if (!Value)
+			{
+				return false;
+			}
+
+			OutRemovedValue = Move(*Value);
+			KeyShard.Items.RemoveByHash(KeyHash, Key);
+			return true;
+		}
+
+		/**
+		* Removes the pair with the specified key if Predicate(const ValueType&) returns true for its value, e.g. to
+		* evict a cache entry only if it hasn't been replaced meanwhile.
+		* @return whether or not the pair was removed
+		*/
+		template<typename PredicateType>
+		bool RemoveIf(KeyInitType Key, const PredicateType& Predicate)
+		{
+			const uint32 KeyHash = KeyFuncs::GetKeyHash(Key);
+			Shard& KeyShard = GetShard(KeyHash);
+
+			WriteScopeLock Lock(KeyShard.Lock);
+			const ValueType* Value = KeyShard.Items.FindByHash(KeyHash, Key);
+			if (!Value || !Predicate(*Value))
+			{
+				return false;
+			}
+
+			KeyShard.Items.RemoveByHash(KeyHash, Key);
+			return true;
+		}
+
+		/**
+		* Calls Func(const KeyType&, const ValueType&) for every pair, locking one shard at a time for reading.
+		* Pairs changed concurrently in shards not visited yet may or may not be seen.
+		*/
+		template<typename FuncType>
+		void ForEach(const FuncType& Func) const
+		{
+			for (uint32 i = 0; i < NumShards; i++)
+			{
+				Shard& CurrentShard = *Shards[i];
+
+				ReadScopeLock Lock(CurrentShard.Lock);
+				for (typename MapType::ConstIterator It = CurrentShard.Items.CreateConstIterator(); It; ++It)
+				{
+					Func(It.Key(), It.Value());
+				}
+			}
+		}
+
+		/** @return The number of pairs, concurrent changes may or may not be counted. */
+		int32 Size() const
+		{
+			int32 Num = 0;
+			for (uint32 i = 0; i < NumShards; i++)
+			{
+				Shard& CurrentShard = *Shards[i];
+
+				ReadScopeLock Lock(CurrentShard.Lock);
+				Num += CurrentShard.Items.Size();
+			}
+			return Num;
+		}
+
+		/** Removes all pairs, one shard at a time. */
+		void Clear()
+		{
+			for (uint32 i = 0; i < NumShards; i++)
+			{
+				Shard& CurrentShard = *Shards[i];
+
+				WriteScopeLock Lock(CurrentShard.Lock);
+				CurrentShard.Items.Clear();
+			}
+		}
+
+		/** Preallocates every shard for its part of the given number of pairs. */
+		void Reserve(int32 Number)
+		{
+			const int32 NumPerShard = Number / int32(NumShards) + 1;
+			for (uint32 i = 0; i < NumShards; i++)
+			{
+				Shard& CurrentShard = *Shards[i];
+
+				WriteScopeLock Lock(CurrentShard.Lock);
+				CurrentShard.Items.Reserve(NumPerShard);
+			}
+		}
+
+		__forceinline uint32 GetNumShards() const
+		{
+			return NumShards;
+		}
+
+	private:
+		/** Picks the shard from the high bits of the mixed hash, the shard's Map uses the low bits of the hash. */
+		__forceinline Shard& GetShard(uint32 KeyHash) const
+		{
+			const uint32 Mixed = uint32((uint64(KeyHash) * 0x9E3779B97F4A7C15ull) >> 32);
+			return *Shards[Mixed & (NumShards - 1)];
+		}
+
+		CacheLinePadded<Shard>* Shards;
+		uint32 NumShards;
+	};
+}
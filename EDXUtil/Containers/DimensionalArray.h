@@ -4,6 +4,8 @@
 #include "../Core/Memory.h"
 #include "../Containers/Array.h"
 #include "../Math/Vector.h"
+#include "../Windows/VirtualMemory.h"
+#include "../Windows/ParallelFor.h"
 
 #include <vector>
 
@@ -101,14 +103,24 @@ namespace EDX
 		ArrayIndex<Dimension> mIndex;
 		T* mpData;
 
+		LargePageMode mLargePageMode;
+		bool mbLargePages;
+		bool mbParallelFirstTouch;
+
 	public:
 		DimensionalArray()
 			: mpData(nullptr)
+			, mLargePageMode(LargePageMode::Default)
+			, mbLargePages(false)
+			, mbParallelFirstTouch(false)
 		{
 		}
 
 		DimensionalArray(const Vec<Dimension, uint>& size, bool bClear = true)
 			: mpData(nullptr)
+			, mLargePageMode(LargePageMode::Default)
+			, mbLargePages(false)
+			, mbParallelFirstTouch(false)
 		{
 			this->Init(size, bClear);
 		}
@@ -120,31 +132,63 @@ namespace EDX
 
 		DimensionalArray(const DimensionalArray& rhs)
 			: mpData(NULL)
+			, mLargePageMode(rhs.mLargePageMode)
+			, mbLargePages(false)
+			, mbParallelFirstTouch(rhs.mbParallelFirstTouch)
 		{
 			this->operator=(rhs);
 		}
 
 		DimensionalArray(DimensionalArray&& rhs)
 			: mpData(NULL)
+			, mLargePageMode(rhs.mLargePageMode)
+			, mbLargePages(false)
+			, mbParallelFirstTouch(rhs.mbParallelFirstTouch)
 		{
 			this->operator=(std::move(rhs));
 		}
 
 		void Init(const Vec<Dimension, uint>& size, bool bClear = true)
 		{
-			Memory::SafeFree(mpData);
+			Free();
 			mIndex.Init(size);
 
-			mpData = Memory::AlignedAlloc<T>(mIndex.LinearSize());
+			mpData = (T*)VirtualMemory::AllocateBulk(mIndex.LinearSize() * sizeof(T), mLargePageMode, mbLargePages);
 			Assert(mpData);
 
-			if (bClear)
+			// Parallel first touch zeroes the data anyway, the pages have to be touched to be placed
+			if (bClear || mbParallelFirstTouch)
 				Clear();
 		}
 
+		/**
+		* Selects whether the following Init calls allocate from large pages, which reduces TLB misses when large
+		* arrays are accessed randomly. Falls back to the heap when large pages are unavailable.
+		*/
+		void SetLargePageMode(LargePageMode mode)
+		{
+			mLargePageMode = mode;
+		}
+
+		/** @return true if the current data is backed by large pages. */
+		bool UsesLargePages() const
+		{
+			return mbLargePages;
+		}
+
+		/**
+		* Makes Init and Clear zero the data from all threads with the static partition of the linear index range, so
+		* that on NUMA systems each part lands on the node of the thread clearing it. Compute loops should then
+		* iterate with ParallelForStatic over LinearSize() to access local memory.
+		*/
+		void SetParallelFirstTouch(bool bEnable)
+		{
+			mbParallelFirstTouch = bEnable;
+		}
+
 		void SetData(const T* pData)
 		{
-			Memory::Memcpy(mpData, pData, LinearSize() * sizeof(T));
+			Memory::BulkMemcpy(mpData, pData, LinearSize() * sizeof(T), true);
 		}
 
 		void SetDim(const Vec<Dimension, uint>& size)
@@ -154,7 +198,10 @@ namespace EDX
 
 		__forceinline void Clear()
 		{
-			Memory::SafeClear(mpData, mIndex.LinearSize());
+			if (mpData && mbParallelFirstTouch)
+				ParallelFirstTouchZero(mpData, mIndex.LinearSize(), sizeof(T));
+			else if (mpData)
+				Memory::BulkMemzero(mpData, mIndex.LinearSize() * sizeof(T), true);
 		}
 
 		DimensionalArray& operator = (const DimensionalArray& rhs)
@@ -164,17 +211,16 @@ namespace EDX
 				Free();
 				Init(rhs.Size());
 			}
-			Memory::Memcpy(mpData, rhs.mpData, LinearSize() * sizeof(T));
+			Memory::BulkMemcpy(mpData, rhs.mpData, LinearSize() * sizeof(T), true);
 			return *this;
 		}
 		DimensionalArray& operator = (DimensionalArray&& rhs)
 		{
-			if (Size() != rhs.Size())
-			{
-				Free();
-				Init(rhs.Size());
-			}
+			Free();
+
+			mIndex = rhs.mIndex;
 			mpData = rhs.mpData;
+			mbLargePages = rhs.mbLargePages;
 			rhs.mpData = NULL;
 			return *this;
 		}
@@ -233,7 +279,11 @@ namespace EDX
 
 		void Free()
 		{
-			Memory::SafeFree(mpData);
+			if (mpData)
+			{
+				VirtualMemory::FreeBulk(mpData, mbLargePages);
+				mpData = nullptr;
+			}
 		}
 	};
 
@@ -243,7 +293,7 @@ namespace EDX
 		lhs.Clear();
 		lhs.ResizeForCopy(rhs.LinearSize());
 
-		Memory::Memcpy(lhs.Data(), rhs.Data(), rhs.LinearSize() * sizeof(T));
+		Memory::BulkMemcpy(lhs.Data(), rhs.Data(), rhs.LinearSize() * sizeof(T), true);
 	}
 
 	template<size_t Dimension, class T>
@@ -252,7 +302,7 @@ namespace EDX
 		lhs.clear();
 		lhs.resize(rhs.LinearSize());
 
-		Memory::Memcpy(lhs.data(), rhs.Data(), rhs.LinearSize() * sizeof(T));
+		Memory::BulkMemcpy(lhs.data(), rhs.Data(), rhs.LinearSize() * sizeof(T), true);
 	}
 
 	typedef DimensionalArray<1, float> Array1f;
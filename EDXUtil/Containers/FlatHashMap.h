@@ -0,0 +1,1059 @@
+#pragma once
+
+#include "../Core/Types.h"
+#include "../Core/Template.h"
+#include "../Core/TypeHash.h"
+#include "../Core/Memory.h"
+#include "AllocationPolicies.h"
+#include "Array.h"
+#include "Map.h"
+
+#include <emmintrin.h>
+#include <initializer_list>
+
+namespace EDX
+{
+	namespace FlatHash_Private
+	{
+		/** Number of control bytes matched by a single SSE2 compare. */
+		enum { GroupWidth = 16 };
+
+		/** Control byte of a free slot. Occupied slots store the 7 low bits of their hash, so only free slots have the top bit set. */
+		static const uint8 CtrlEmpty = 0x80;
+
+		/** Unit of the table allocation, keeps the slots 16-byte aligned. */
+		typedef AlignedBytes<GroupWidth, GroupWidth> Chunk;
+
+		/** GroupWidth consecutive control bytes, loaded with one unaligned load. */
+		struct Group
+		{
+			__forceinline explicit Group(const uint8* Pos)
+				: Ctrl(_mm_loadu_si128((const __m128i*)Pos))
+			{
+			}
+
+			/** @return a bit mask of the slots whose control byte is H2 */
+			__forceinline uint32 Match(uint8 H2) const
+			{
+				return uint32(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(char(H2)), Ctrl)));
+			}
+
+			/** @return a bit mask of the free slots */
+			__forceinline uint32 MatchEmpty() const
+			{
+				return uint32(_mm_movemask_epi8(Ctrl));
+			}
+
+			__m128i Ctrl;
+		};
+
+		/** Spreads a key hash over 64 bits, the table uses the top bits for the home slot and lower bits for the control byte. */
+		__forceinline uint64 MixHash(uint32 KeyHash)
+		{
+			return uint64(KeyHash) * 0x9E3779B97F4A7C15ull;
+		}
+
+		__forceinline uint8 GetH2(uint64 Mixed)
+		{
+			return uint8(Mixed >> 25) & 0x7F;
+		}
+
+		__forceinline bool IsFull(uint8 Ctrl)
+		{
+			return (Ctrl & CtrlEmpty) == 0;
+		}
+
+		/** Sets a control byte. The first GroupWidth bytes are mirrored past the end so that groups can be loaded across the wrap. */
+		__forceinline void SetCtrl(uint8* Ctrl, uint32 Capacity, uint32 Index, uint8 Value)
+		{
+			Ctrl[Index] = Value;
+			if (Index < GroupWidth)
+			{
+				Ctrl[Capacity + Index] = Value;
+			}
+		}
+
+		/** @return the first free slot at or after Pos, wrapping around. The table must have a free slot. */
+		__forceinline uint32 FindEmptySlot(const uint8* Ctrl, uint32 Mask, uint32 Pos)
+		{
+			for (;; Pos = (Pos + GroupWidth) & Mask)
+			{
+				const uint32 Empty = Group(Ctrl + Pos).MatchEmpty();
+				if (Empty)
+				{
+					return (Pos + Math::CountTrailingZeros(Empty)) & Mask;
+				}
+			}
+		}
+	}
+
+	template<typename KeyType, typename ValueType, typename Allocator, typename KeyFuncs>
+	class FlatHashMap;
+
+	/**
+	* Open addressing hash set storing its elements inline in a single allocation, for hot lookup paths where
+	* Set's sparse array and hash chains cost a cache miss per step.
+	*
+	* Every slot has a control byte, free or 7 bits of the element hash, kept in a separate array. Lookups compare
+	* the control bytes of 16 slots at once with SSE2 and only look at elements whose bits match. Slots are probed
+	* linearly from the home slot of the hash, so a removal shifts the following elements of the run back instead
+	* of leaving a tombstone; lookups never have to step over dead slots and the table doesn't degrade with churn.
+	*
+	* The table is kept at most 3/4 full, removals rehash the shifted elements. Elements are relocated bitwise when
+	* the table grows, and pointers to elements are invalidated by any addition or removal. Duplicate keys are not
+	* supported.
+	*/
+	template<typename InElementType, typename KeyFuncs = DefaultKeyFuncs<InElementType>, typename Allocator = DefaultAllocator>
+	class FlatHashSet
+	{
+		template<typename, typename, typename, typename>
+		friend class FlatHashMap;
+
+		static_assert(!KeyFuncs::bAllowDuplicateKeys, "FlatHashSet doesn't support duplicate keys");
+		static_assert(ALIGNOF(InElementType) <= FlatHash_Private::GroupWidth, "FlatHashSet elements must not need more than 16-byte alignment");
+
+		typedef typename KeyFuncs::KeyInitType     KeyInitType;
+		typedef typename KeyFuncs::ElementInitType ElementInitType;
+
+		typedef typename Allocator::template ForElementType<FlatHash_Private::Chunk> AllocationType;
+
+	public:
+		typedef InElementType ElementType;
+
+		FlatHashSet()
+			: NumElements(0)
+			, Capacity(0)
+			, HashShift(0)
+		{
+		}
+
+		FlatHashSet(std::initializer_list<ElementType> InitList)
+			: FlatHashSet()
+		{
+			Append(InitList);
+		}
+
+		FlatHashSet(const FlatHashSet& Other)
+			: FlatHashSet()
+		{
+			*this = Other;
+		}
+
+		FlatHashSet(FlatHashSet&& Other)
+			: FlatHashSet()
+		{
+			*this = Move(Other);
+		}
+
+		~FlatHashSet()
+		{
+			DestructElements();
+		}
+
+		FlatHashSet& operator=(const FlatHashSet& Other)
+		{
+			if (this != &Other)
+			{
+				DestructElements();
+				Allocation.ResizeAllocation(0, GetNumChunks(Other.Capacity), sizeof(FlatHash_Private::Chunk));
+				NumElements = Other.NumElements;
+				Capacity = Other.Capacity;
+				HashShift = Other.HashShift;
+
+				if (Capacity > 0)
+				{
+					// Same capacity and hash, every element goes to the same slot
+					const uint8* OtherCtrl = Other.GetCtrl();
+					const ElementType* OtherSlots = Other.GetSlots();
+					ElementType* Slots = GetSlots();
+
+					Memory::Memcpy(GetCtrl(), OtherCtrl, Capacity + FlatHash_Private::GroupWidth);
+					for (int32 i = 0; i < Capacity; i++)
+					{
+						if (FlatHash_Private::IsFull(OtherCtrl[i]))
+						{
+							new(Slots + i) ElementType(OtherSlots[i]);
+						}
+					}
+				}
+			}
+			return *this;
+		}
+
+		FlatHashSet& operator=(FlatHashSet&& Other)
+		{
+			if (this != &Other)
+			{
+				DestructElements();
+				Allocation.MoveToEmpty(Other.Allocation);
+				NumElements = Other.NumElements;
+				Capacity = Other.Capacity;
+				HashShift = Other.HashShift;
+
+				Other.NumElements = 0;
+				Other.Capacity = 0;
+				Other.HashShift = 0;
+			}
+			return *this;
+		}
+
+		/**
+		* Adds an element to the set, replacing the element with the same key if there is one.
+		*
+		* @param	bIsAlreadyInSetPtr	[out]	Optional pointer to bool that will be set depending on whether the key was already in the set
+		* @return	A reference to the element stored in the set, valid until the next change to the set.
+		*/
+		__forceinline ElementType& Add(const ElementType& InElement, bool* bIsAlreadyInSetPtr = nullptr)
+		{
+			return EmplaceByKey(KeyFuncs::GetSetKey(InElement), InElement, bIsAlreadyInSetPtr);
+		}
+		__forceinline ElementType& Add(ElementType&& InElement, bool* bIsAlreadyInSetPtr = nullptr)
+		{
+			return EmplaceByKey(KeyFuncs::GetSetKey(InElement), Move(InElement), bIsAlreadyInSetPtr);
+		}
+
+		/**
+		* Adds an element to the set, using a hash of its key the caller already has.
+		* @param	KeyHash		Must be KeyFuncs::GetKeyHash of the element's key
+		*/
+		__forceinline ElementType& AddByHash(uint32 KeyHash, const ElementType& InElement, bool* bIsAlreadyInSetPtr = nullptr)
+		{
+			return EmplaceByHash(KeyHash, KeyFuncs::GetSetKey(InElement), InElement, bIsAlreadyInSetPtr);
+		}
+		__forceinline ElementType& AddByHash(uint32 KeyHash, ElementType&& InElement, bool* bIsAlreadyInSetPtr = nullptr)
+		{
+			return EmplaceByHash(KeyHash, KeyFuncs::GetSetKey(InElement), Move(InElement), bIsAlreadyInSetPtr);
+		}
+
+		/**
+		* Constructs an element from Args and adds it to the set, replacing the element with the same key if there is one.
+		*
+		* @param	bIsAlreadyInSetPtr	[out]	Optional pointer to bool that will be set depending on whether the key was already in the set
+		* @return	A reference to the element stored in the set, valid until the next change to the set.
+		*/
+		template<typename ArgsType>
+		ElementType& Emplace(ArgsType&& Args, bool* bIsAlreadyInSetPtr = nullptr)
+		{
+			// The key is only known once the element is built
+			TypeCompatibleBytes<ElementType> NewElementBytes;
+			ElementType& NewElement = *new(&NewElementBytes) ElementType(Forward<ArgsType>(Args));
+
+			const uint64 Mixed = FlatHash_Private::MixHash(KeyFuncs::GetKeyHash(KeyFuncs::GetSetKey(NewElement)));
+			const int32 ExistingIndex = FindIndex(KeyFuncs::GetSetKey(NewElement), Mixed);
+			if (bIsAlreadyInSetPtr)
+			{
+				*bIsAlreadyInSetPtr = ExistingIndex != INDEX_NONE;
+			}
+
+			if (ExistingIndex != INDEX_NONE)
+			{
+				ElementType& Existing = GetSlots()[ExistingIndex];
+				MoveByRelocate(Existing, NewElement);
+				return Existing;
+			}
+
+			ElementType* Slot = InsertUninitialized(Mixed);
+			RelocateConstructItems<ElementType>(Slot, &NewElement, 1);
+			return *Slot;
+		}
+
+		void Append(std::initializer_list<ElementType> InitList)
+		{
+			Reserve(NumElements + (int32)InitList.size());
+			for (const ElementType& Element : InitList)
+			{
+				Add(Element);
+			}
+		}
+
+		template<typename ArrayAllocator>
+		void Append(const Array<ElementType, ArrayAllocator>& InElements)
+		{
+			Reserve(NumElements + InElements.Size());
+			for (const ElementType& Element : InElements)
+			{
+				Add(Element);
+			}
+		}
+
+		/**
+		* Removes the element with the given key.
+		* @return The number of elements removed, 0 or 1.
+		*/
+		__forceinline int32 Remove(KeyInitType Key)
+		{
+			return RemoveByHash(KeyFuncs::GetKeyHash(Key), Key);
+		}
+
+		/** Removes the element with the given key, using a hash of the key the caller already has. See FindByHash. */
+		template<typename ComparableKey>
+		int32 RemoveByHash(uint32 KeyHash, const ComparableKey& Key)
+		{
+			const int32 Index = FindIndex(Key, FlatHash_Private::MixHash(KeyHash));
+			if (Index == INDEX_NONE)
+			{
+				return 0;
+			}
+
+			RemoveAtIndex(uint32(Index));
+			return 1;
+		}
+
+		/**
+		* Finds the element with the given key.
+		* @return A pointer to the element, or nullptr if the key isn't in the set. Valid until the next change to the set.
+		*/
+		__forceinline ElementType* Find(KeyInitType Key)
+		{
+			return FindByHash(KeyFuncs::GetKeyHash(Key), Key);
+		}
+		__forceinline const ElementType* Find(KeyInitType Key) const
+		{
+			return const_cast<FlatHashSet*>(this)->Find(Key);
+		}
+
+		/**
+		* Finds the element with the given key, using a hash of the key the caller already has. The key can be of any
+		* type KeyFuncs::Matches accepts, as with Set::FindIdByHash.
+		* @param KeyHash - Must be the hash KeyFuncs::GetKeyHash gives for the equivalent key.
+		*/
+		template<typename ComparableKey>
+		__forceinline ElementType* FindByHash(uint32 KeyHash, const ComparableKey& Key)
+		{
+			const int32 Index = FindIndex(Key, FlatHash_Private::MixHash(KeyHash));
+			return Index != INDEX_NONE ? GetSlots() + Index : nullptr;
+		}
+		template<typename ComparableKey>
+		__forceinline const ElementType* FindByHash(uint32 KeyHash, const ComparableKey& Key) const
+		{
+			return const_cast<FlatHashSet*>(this)->FindByHash(KeyHash, Key);
+		}
+
+		__forceinline bool Contains(KeyInitType Key) const
+		{
+			return FindIndex(Key, FlatHash_Private::MixHash(KeyFuncs::GetKeyHash(Key))) != INDEX_NONE;
+		}
+
+		template<typename ComparableKey>
+		__forceinline bool ContainsByHash(uint32 KeyHash, const ComparableKey& Key) const
+		{
+			return FindIndex(Key, FlatHash_Private::MixHash(KeyHash)) != INDEX_NONE;
+		}
+
+		__forceinline int32 Size() const
+		{
+			return NumElements;
+		}
+
+		/** @return the number of elements the set can hold before it grows */
+		__forceinline int32 Max() const
+		{
+			return GetMaxLoad(Capacity);
+		}
+
+		/**
+		* Removes all elements from the set.
+		* @param ExpectedNumElements - The number of elements about to be added, the table is sized for it.
+		*/
+		void Clear(int32 ExpectedNumElements = 0)
+		{
+			Reset();
+
+			const int32 NewCapacity = GetCapacityFor(ExpectedNumElements);
+			if (NewCapacity != Capacity)
+			{
+				Rehash(NewCapacity);
+			}
+		}
+
+		/** Removes all elements from the set, keeping the table allocated. */
+		void Reset()
+		{
+			DestructElements();
+			NumElements = 0;
+			if (Capacity > 0)
+			{
+				Memory::Memset(GetCtrl(), FlatHash_Private::CtrlEmpty, Capacity + FlatHash_Private::GroupWidth);
+			}
+		}
+
+		/** Grows the table so that Number elements fit without rehashing. */
+		void Reserve(int32 Number)
+		{
+			const int32 NewCapacity = GetCapacityFor(Number);
+			if (NewCapacity > Capacity)
+			{
+				Rehash(NewCapacity);
+			}
+		}
+
+		/** Shrinks the table to the smallest size that holds the current elements. */
+		void Shrink()
+		{
+			const int32 NewCapacity = GetCapacityFor(NumElements);
+			if (NewCapacity < Capacity)
+			{
+				Rehash(NewCapacity);
+			}
+		}
+
+		__forceinline uint32 GetAllocatedSize() const
+		{
+			return uint32(GetNumChunks(Capacity) * sizeof(FlatHash_Private::Chunk));
+		}
+
+	private:
+		/**
+		* Iterates the slots starting right after a free slot. A removal only shifts elements of the run that
+		* follows the removed one back, and a run never goes past a free slot, so elements that haven't been
+		* visited yet can't move to a slot that has.
+		*/
+		template<bool bConst>
+		class BaseIterator
+		{
+		protected:
+			typedef typename ChooseClass<bConst, const FlatHashSet, FlatHashSet>::Result SetType;
+			typedef typename ChooseClass<bConst, const ElementType, ElementType>::Result ItElementType;
+
+		public:
+			__forceinline BaseIterator(SetType& InSet, bool bEnd = false)
+				: TheSet(InSet)
+				, Start(bEnd ? 0 : InSet.GetIterationStart())
+				, Offset(bEnd ? InSet.Capacity : 0)
+			{
+				SkipEmpty();
+			}
+
+			__forceinline BaseIterator& operator++()
+			{
+				++Offset;
+				SkipEmpty();
+				return *this;
+			}
+
+			/** conversion to "bool" returning true if the iterator is valid. */
+			__forceinline explicit operator bool() const
+			{
+				return Offset < TheSet.Capacity;
+			}
+			/** inverse of the "bool" operator */
+			__forceinline bool operator !() const
+			{
+				return !(bool)*this;
+			}
+
+			__forceinline friend bool operator==(const BaseIterator& Lhs, const BaseIterator& Rhs) { return &Lhs.TheSet == &Rhs.TheSet && Lhs.Offset == Rhs.Offset; }
+			__forceinline friend bool operator!=(const BaseIterator& Lhs, const BaseIterator& Rhs) { return &Lhs.TheSet != &Rhs.TheSet || Lhs.Offset != Rhs.Offset; }
+
+			__forceinline ItElementType& operator*() const
+			{
+				return TheSet.GetSlots()[GetIndex()];
+			}
+			__forceinline ItElementType* operator->() const
+			{
+				return TheSet.GetSlots() + GetIndex();
+			}
+
+		protected:
+			__forceinline uint32 GetIndex() const
+			{
+				return uint32(Start + Offset) & uint32(TheSet.Capacity - 1);
+			}
+
+			__forceinline void SkipEmpty()
+			{
+				while (Offset < TheSet.Capacity && !FlatHash_Private::IsFull(TheSet.GetCtrl()[GetIndex()]))
+				{
+					++Offset;
+				}
+			}
+
+			SetType& TheSet;
+			int32 Start;
+			int32 Offset;
+		};
+
+	public:
+		class Iterator : public BaseIterator<false>
+		{
+		public:
+			__forceinline Iterator(FlatHashSet& InSet, bool bEnd = false)
+				: BaseIterator<false>(InSet, bEnd)
+			{
+			}
+
+			/** Removes the current element. The iterator must be incremented before it is used again. */
+			__forceinline void RemoveCurrent()
+			{
+				this->TheSet.RemoveAtIndex(this->GetIndex());
+
+				// The slot may now hold a following element which hasn't been visited, look at it again
+				--this->Offset;
+			}
+		};
+
+		class ConstIterator : public BaseIterator<true>
+		{
+		public:
+			__forceinline ConstIterator(const FlatHashSet& InSet, bool bEnd = false)
+				: BaseIterator<true>(InSet, bEnd)
+			{
+			}
+		};
+
+		__forceinline Iterator CreateIterator()
+		{
+			return Iterator(*this);
+		}
+		__forceinline ConstIterator CreateConstIterator() const
+		{
+			return ConstIterator(*this);
+		}
+
+		/**
+		* DO NOT USE DIRECTLY
+		* STL-like iterators to enable range-based for loop support.
+		*/
+		__forceinline friend Iterator      begin(FlatHashSet& Set) { return Iterator(Set); }
+		__forceinline friend ConstIterator begin(const FlatHashSet& Set) { return ConstIterator(Set); }
+		__forceinline friend Iterator      end(FlatHashSet& Set) { return Iterator(Set, true); }
+		__forceinline friend ConstIterator end(const FlatHashSet& Set) { return ConstIterator(Set, true); }
+
+	private:
+		__forceinline ElementType* GetSlots() const
+		{
+			return (ElementType*)Allocation.GetAllocation();
+		}
+
+		/** Control bytes follow the slots in the same allocation. */
+		__forceinline uint8* GetCtrl() const
+		{
+			return (uint8*)Allocation.GetAllocation() + GetSlotBytes(Capacity);
+		}
+
+		static __forceinline SIZE_T GetSlotBytes(int32 InCapacity)
+		{
+			return Align(SIZE_T(InCapacity) * sizeof(ElementType), FlatHash_Private::GroupWidth);
+		}
+
+		static __forceinline int32 GetNumChunks(int32 InCapacity)
+		{
+			return InCapacity > 0 ? int32((GetSlotBytes(InCapacity) + InCapacity + FlatHash_Private::GroupWidth) / sizeof(FlatHash_Private::Chunk)) : 0;
+		}
+
+		static __forceinline int32 GetMaxLoad(int32 InCapacity)
+		{
+			return InCapacity - InCapacity / 4;
+		}
+
+		/** @return the smallest power of two table, of at least one group, holding Number elements */
+		static int32 GetCapacityFor(int32 Number)
+		{
+			if (Number <= 0)
+			{
+				return 0;
+			}
+
+			int32 Result = FlatHash_Private::GroupWidth;
+			while (GetMaxLoad(Result) < Number)
+			{
+				Result *= 2;
+			}
+			return Result;
+		}
+
+		__forceinline uint32 GetHomeSlot(uint64 Mixed) const
+		{
+			return uint32(Mixed >> HashShift);
+		}
+
+		int32 GetIterationStart() const
+		{
+			if (Capacity == 0)
+			{
+				return 0;
+			}
+
+			const uint32 Mask = uint32(Capacity - 1);
+			return int32((FlatHash_Private::FindEmptySlot(GetCtrl(), Mask, 0) + 1) & Mask);
+		}
+
+		/** @return the slot of the element with the given key, INDEX_NONE if there is none */
+		template<typename ComparableKey>
+		int32 FindIndex(const ComparableKey& Key, uint64 Mixed) const
+		{
+			if (NumElements == 0)
+			{
+				return INDEX_NONE;
+			}
+
+			const uint8 H2 = FlatHash_Private::GetH2(Mixed);
+			const uint8* Ctrl = GetCtrl();
+			const ElementType* Slots = GetSlots();
+			const uint32 Mask = uint32(Capacity - 1);
+
+			for (uint32 Pos = GetHomeSlot(Mixed);; Pos = (Pos + FlatHash_Private::GroupWidth) & Mask)
+			{
+				const FlatHash_Private::Group Group(Ctrl + Pos);
+				for (uint32 Matches = Group.Match(H2); Matches; Matches &= Matches - 1)
+				{
+					const uint32 Index = (Pos + Math::CountTrailingZeros(Matches)) & Mask;
+					if (KeyFuncs::Matches(KeyFuncs::GetSetKey(Slots[Index]), Key))
+					{
+						return int32(Index);
+					}
+				}
+
+				// Runs have no holes, a free slot ends the search
+				if (Group.MatchEmpty())
+				{
+					return INDEX_NONE;
+				}
+			}
+		}
+
+		/** Claims the first free slot of the probe sequence of a key known not to be in the set, growing the table first if needed. */
+		ElementType* InsertUninitialized(uint64 Mixed)
+		{
+			if (NumElements >= GetMaxLoad(Capacity))
+			{
+				Rehash(Capacity > 0 ? Capacity * 2 : int32(FlatHash_Private::GroupWidth));
+			}
+
+			uint8* Ctrl = GetCtrl();
+			const uint32 Index = FlatHash_Private::FindEmptySlot(Ctrl, uint32(Capacity - 1), GetHomeSlot(Mixed));
+			FlatHash_Private::SetCtrl(Ctrl, Capacity, Index, FlatHash_Private::GetH2(Mixed));
+			++NumElements;
+
+			return GetSlots() + Index;
+		}
+
+		template<typename ArgsType>
+		__forceinline ElementType& EmplaceByKey(KeyInitType Key, ArgsType&& Args, bool* bIsAlreadyInSetPtr)
+		{
+			return EmplaceByHash(KeyFuncs::GetKeyHash(Key), Key, Forward<ArgsType>(Args), bIsAlreadyInSetPtr);
+		}
+
+		template<typename ComparableKey, typename ArgsType>
+		ElementType& EmplaceByHash(uint32 KeyHash, const ComparableKey& Key, ArgsType&& Args, bool* bIsAlreadyInSetPtr)
+		{
+			const uint64 Mixed = FlatHash_Private::MixHash(KeyHash);
+			const int32 ExistingIndex = FindIndex(Key, Mixed);
+			if (bIsAlreadyInSetPtr)
+			{
+				*bIsAlreadyInSetPtr = ExistingIndex != INDEX_NONE;
+			}
+
+			// Args may refer to an element of the set, which replacing it or growing the table destroys, build the new one aside first
+			TypeCompatibleBytes<ElementType> NewElementBytes;
+			ElementType& NewElement = *new(&NewElementBytes) ElementType(Forward<ArgsType>(Args));
+
+			if (ExistingIndex != INDEX_NONE)
+			{
+				ElementType& Existing = GetSlots()[ExistingIndex];
+				MoveByRelocate(Existing, NewElement);
+				return Existing;
+			}
+
+			ElementType* Slot = InsertUninitialized(Mixed);
+			RelocateConstructItems<ElementType>(Slot, &NewElement, 1);
+			return *Slot;
+		}
+
+		/** Destroys the element in Index and shifts the rest of its run back over it (backward shift deletion). */
+		void RemoveAtIndex(uint32 Index)
+		{
+			uint8* Ctrl = GetCtrl();
+			ElementType* Slots = GetSlots();
+			const uint32 Mask = uint32(Capacity - 1);
+
+			DestructItems(Slots + Index, 1);
+
+			uint32 Hole = Index;
+			for (uint32 Next = (Hole + 1) & Mask; FlatHash_Private::IsFull(Ctrl[Next]); Next = (Next + 1) & Mask)
+			{
+				// An element can fill the hole if its home slot isn't between the hole and itself
+				const uint32 Home = GetHomeSlot(FlatHash_Private::MixHash(KeyFuncs::GetKeyHash(KeyFuncs::GetSetKey(Slots[Next]))));
+				if (((Next - Home) & Mask) >= ((Next - Hole) & Mask))
+				{
+					RelocateConstructItems<ElementType>(Slots + Hole, Slots + Next, 1);
+					FlatHash_Private::SetCtrl(Ctrl, Capacity, Hole, Ctrl[Next]);
+					Hole = Next;
+				}
+			}
+
+			FlatHash_Private::SetCtrl(Ctrl, Capacity, Hole, FlatHash_Private::CtrlEmpty);
+			--NumElements;
+		}
+
+		/** Moves every element to a table of NewCapacity slots, a power of two of at least one group, or frees the table if 0. */
+		void Rehash(int32 NewCapacity)
+		{
+			Assert(NewCapacity == 0 || (NewCapacity >= FlatHash_Private::GroupWidth && (NewCapacity & (NewCapacity - 1)) == 0));
+			Assert(GetMaxLoad(NewCapacity) >= NumElements);
+
+			AllocationType NewAllocation;
+			const uint32 NewHashShift = NewCapacity > 0 ? 64 - Math::FloorLog2(uint32(NewCapacity)) : 0;
+
+			if (NewCapacity > 0)
+			{
+				NewAllocation.ResizeAllocation(0, GetNumChunks(NewCapacity), sizeof(FlatHash_Private::Chunk));
+
+				ElementType* NewSlots = (ElementType*)NewAllocation.GetAllocation();
+				uint8* NewCtrl = (uint8*)NewSlots + GetSlotBytes(NewCapacity);
+				const uint32 NewMask = uint32(NewCapacity - 1);
+				Memory::Memset(NewCtrl, FlatHash_Private::CtrlEmpty, NewCapacity + FlatHash_Private::GroupWidth);
+
+				const uint8* Ctrl = GetCtrl();
+				ElementType* Slots = GetSlots();
+				for (int32 i = 0; i < Capacity; i++)
+				{
+					if (FlatHash_Private::IsFull(Ctrl[i]))
+					{
+						const uint64 Mixed = FlatHash_Private::MixHash(KeyFuncs::GetKeyHash(KeyFuncs::GetSetKey(Slots[i])));
+						const uint32 Index = FlatHash_Private::FindEmptySlot(NewCtrl, NewMask, uint32(Mixed >> NewHashShift));
+
+						FlatHash_Private::SetCtrl(NewCtrl, uint32(NewCapacity), Index, FlatHash_Private::GetH2(Mixed));
+						RelocateConstructItems<ElementType>(NewSlots + Index, Slots + i, 1);
+					}
+				}
+			}
+
+			Allocation.MoveToEmpty(NewAllocation);
+			Capacity = NewCapacity;
+			HashShift = NewHashShift;
+		}
+
+		void DestructElements()
+		{
+			if (TypeTraits<ElementType>::NeedsDestructor)
+			{
+				const uint8* Ctrl = GetCtrl();
+				ElementType* Slots = GetSlots();
+				for (int32 i = 0; i < Capacity; i++)
+				{
+					if (FlatHash_Private::IsFull(Ctrl[i]))
+					{
+						DestructItems(Slots + i, 1);
+					}
+				}
+			}
+		}
+
+		AllocationType Allocation;
+		int32 NumElements;
+		int32 Capacity;
+		uint32 HashShift;
+	};
+
+	/**
+	* Map from keys to values stored as Pair elements of a FlatHashSet, see FlatHashSet for the trade-offs. It follows
+	* the Map interface for unique keys, so that hot maps can switch over by changing the type.
+	*/
+	template<typename KeyType, typename ValueType, typename Allocator = DefaultAllocator, typename KeyFuncs = DefaultMapKeyFuncs<KeyType, ValueType, false>>
+	class FlatHashMap
+	{
+	public:
+		typedef typename TypeTraits<KeyType  >::ConstPointerType KeyConstPointerType;
+		typedef typename TypeTraits<KeyType  >::ConstInitType    KeyInitType;
+		typedef typename TypeTraits<ValueType>::ConstInitType    ValueInitType;
+		typedef Pair<KeyType, ValueType> ElementType;
+
+	private:
+		typedef FlatHashSet<ElementType, KeyFuncs, Allocator> PairSetType;
+
+	public:
+		FlatHashMap() = default;
+		FlatHashMap(FlatHashMap&&) = default;
+		FlatHashMap(const FlatHashMap&) = default;
+		FlatHashMap& operator=(FlatHashMap&&) = default;
+		FlatHashMap& operator=(const FlatHashMap&) = default;
+
+		/**
+		* Sets the value associated with a key.
+		*
+		* @return A reference to the value as stored in the map.  The reference is only valid until the next change to any key in the map.
+		*/
+		__forceinline ValueType& Add(const KeyType&  InKey, const ValueType&  InValue) { return Emplace(InKey, InValue); }
+		__forceinline ValueType& Add(const KeyType&  InKey, ValueType&& InValue) { return Emplace(InKey, Move(InValue)); }
+		__forceinline ValueType& Add(KeyType&& InKey, const ValueType&  InValue) { return Emplace(Move(InKey), InValue); }
+		__forceinline ValueType& Add(KeyType&& InKey, ValueType&& InValue) { return Emplace(Move(InKey), Move(InValue)); }
+
+		/**
+		* Sets a default value associated with a key.
+		*
+		* @return A reference to the value as stored in the map.  The reference is only valid until the next change to any key in the map.
+		*/
+		__forceinline ValueType& Add(const KeyType&  InKey) { return Emplace(InKey); }
+		__forceinline ValueType& Add(KeyType&& InKey) { return Emplace(Move(InKey)); }
+
+		template <typename InitKeyType, typename InitValueType>
+		ValueType& Emplace(InitKeyType&& InKey, InitValueType&& InValue)
+		{
+			return Pairs.EmplaceByKey(InKey, PairInitializer<InitKeyType&&, InitValueType&&>(Forward<InitKeyType>(InKey), Forward<InitValueType>(InValue)), nullptr).Value;
+		}
+
+		template <typename InitKeyType>
+		ValueType& Emplace(InitKeyType&& InKey)
+		{
+			return Pairs.EmplaceByKey(InKey, KeyInitializer<InitKeyType&&>(Forward<InitKeyType>(InKey)), nullptr).Value;
+		}
+
+		/**
+		* Sets the value associated with a key, using a hash of the key the caller already has.
+		* @param KeyHash - Must be KeyFuncs::GetKeyHash of InKey.
+		*/
+		template <typename InitKeyType, typename InitValueType>
+		ValueType& AddByHash(uint32 KeyHash, InitKeyType&& InKey, InitValueType&& InValue)
+		{
+			return Pairs.EmplaceByHash(KeyHash, InKey, PairInitializer<InitKeyType&&, InitValueType&&>(Forward<InitKeyType>(InKey), Forward<InitValueType>(InValue)), nullptr).Value;
+		}
+
+		/**
+		* Removes the value associated with a key.
+		* @return The number of values that were associated with the key, 0 or 1.
+		*/
+		__forceinline int32 Remove(KeyConstPointerType InKey)
+		{
+			return Pairs.Remove(InKey);
+		}
+
+		/** Removes the value associated with a key, using a hash of the key the caller already has. See FindByHash. */
+		template<typename ComparableKey>
+		__forceinline int32 RemoveByHash(uint32 KeyHash, const ComparableKey& Key)
+		{
+			return Pairs.RemoveByHash(KeyHash, Key);
+		}
+
+		/**
+		* Removes the pair with the specified key and copies the value that was removed to the ref parameter
+		* @return whether or not the key was found
+		*/
+		bool RemoveAndCopyValue(KeyInitType Key, ValueType& OutRemovedValue)
+		{
+			const int32 Index = Pairs.FindIndex(Key, FlatHash_Private::MixHash(KeyFuncs::GetKeyHash(Key)));
+			if (Index == INDEX_NONE)
+			{
+				return false;
+			}
+
+			OutRemovedValue = Move(Pairs.GetSlots()[Index].Value);
+			Pairs.RemoveAtIndex(uint32(Index));
+			return true;
+		}
+
+		/** Finds a pair with the specified key, removes it from the map, and returns the value. Asserts if the key isn't in the map. */
+		ValueType FindAndRemoveChecked(KeyConstPointerType Key)
+		{
+			const int32 Index = Pairs.FindIndex(Key, FlatHash_Private::MixHash(KeyFuncs::GetKeyHash(Key)));
+			Assert(Index != INDEX_NONE);
+
+			ValueType Result = Move(Pairs.GetSlots()[Index].Value);
+			Pairs.RemoveAtIndex(uint32(Index));
+			return Result;
+		}
+
+		/**
+		* @return A pointer to the value associated with the specified key, or nullptr if the key isn't contained in this map.  The pointer
+		*			is only valid until the next change to any key in the map.
+		*/
+		__forceinline ValueType* Find(KeyConstPointerType Key)
+		{
+			if (auto* Pair = Pairs.Find(Key))
+			{
+				return &Pair->Value;
+			}
+
+			return nullptr;
+		}
+		__forceinline const ValueType* Find(KeyConstPointerType Key) const
+		{
+			return const_cast<FlatHashMap*>(this)->Find(Key);
+		}
+
+		/**
+		* Returns the value associated with a specified key, using a hash of the key the caller already has. As with
+		* Map::FindByHash, the key can be of any type KeyFuncs::Matches accepts.
+		*/
+		template<typename ComparableKey>
+		__forceinline ValueType* FindByHash(uint32 KeyHash, const ComparableKey& Key)
+		{
+			if (auto* Pair = Pairs.FindByHash(KeyHash, Key))
+			{
+				return &Pair->Value;
+			}
+
+			return nullptr;
+		}
+		template<typename ComparableKey>
+		__forceinline const ValueType* FindByHash(uint32 KeyHash, const ComparableKey& Key) const
+		{
+			return const_cast<FlatHashMap*>(this)->FindByHash(KeyHash, Key);
+		}
+
+		/**
+		* Returns the value associated with a specified key, or if none exists, adds a value using the default constructor.
+		* The key is hashed once for both.
+		*/
+		__forceinline ValueType& FindOrAdd(const KeyType&  Key) { return FindOrAddImpl(KeyFuncs::GetKeyHash(Key), Key); }
+		__forceinline ValueType& FindOrAdd(KeyType&& Key) { return FindOrAddImpl(KeyFuncs::GetKeyHash(Key), Move(Key)); }
+
+		/** FindOrAdd with a hash of the key the caller already has, KeyFuncs::GetKeyHash of Key. */
+		__forceinline ValueType& FindOrAddByHash(uint32 KeyHash, const KeyType&  Key) { return FindOrAddImpl(KeyHash, Key); }
+		__forceinline ValueType& FindOrAddByHash(uint32 KeyHash, KeyType&& Key) { return FindOrAddImpl(KeyHash, Move(Key)); }
+
+		/** @return The value associated with the specified key, or triggers an assertion if the key does not exist. */
+		__forceinline const ValueType& FindChecked(KeyConstPointerType Key) const
+		{
+			const auto* Pair = Pairs.Find(Key);
+			Assert(Pair != nullptr);
+			return Pair->Value;
+		}
+		__forceinline ValueType& FindChecked(KeyConstPointerType Key)
+		{
+			auto* Pair = Pairs.Find(Key);
+			Assert(Pair != nullptr);
+			return Pair->Value;
+		}
+
+		/** @return The value associated with the specified key, or the default value for the ValueType if the key isn't contained in this map. */
+		__forceinline ValueType FindRef(KeyConstPointerType Key) const
+		{
+			if (const auto* Pair = Pairs.Find(Key))
+			{
+				return Pair->Value;
+			}
+
+			return ValueType();
+		}
+
+		__forceinline bool Contains(KeyConstPointerType Key) const
+		{
+			return Pairs.Contains(Key);
+		}
+
+		template<typename ComparableKey>
+		__forceinline bool ContainsByHash(uint32 KeyHash, const ComparableKey& Key) const
+		{
+			return Pairs.ContainsByHash(KeyHash, Key);
+		}
+
+		__forceinline ValueType& operator[](KeyConstPointerType Key) { return FindChecked(Key); }
+		__forceinline const ValueType& operator[](KeyConstPointerType Key) const { return FindChecked(Key); }
+
+		/** Generates an array from the keys in this map. */
+		template<typename ArrayAllocator> void GenerateKeyArray(Array<KeyType, ArrayAllocator>& OutArray) const
+		{
+			OutArray.Clear(Pairs.Size());
+			for (const ElementType& Pair : Pairs)
+			{
+				new(OutArray) KeyType(Pair.Key);
+			}
+		}
+
+		/** Generates an array from the values in this map. */
+		template<typename ArrayAllocator> void GenerateValueArray(Array<ValueType, ArrayAllocator>& OutArray) const
+		{
+			OutArray.Clear(Pairs.Size());
+			for (const ElementType& Pair : Pairs)
+			{
+				new(OutArray) ValueType(Pair.Value);
+			}
+		}
+
+		__forceinline void Clear(int32 ExpectedNumElements = 0)
+		{
+			Pairs.Clear(ExpectedNumElements);
+		}
+
+		__forceinline void Reset()
+		{
+			Pairs.Reset();
+		}
+
+		__forceinline void Shrink()
+		{
+			Pairs.Shrink();
+		}
+
+		__forceinline void Reserve(int32 Number)
+		{
+			Pairs.Reserve(Number);
+		}
+
+		__forceinline int32 Size() const
+		{
+			return Pairs.Size();
+		}
+
+		__forceinline uint32 GetAllocatedSize() const
+		{
+			return Pairs.GetAllocatedSize();
+		}
+
+		/** Map iterator, also gives access to the key and value of the current pair. */
+		class Iterator : public PairSetType::Iterator
+		{
+		public:
+			__forceinline Iterator(FlatHashMap& InMap, bool bEnd = false)
+				: PairSetType::Iterator(InMap.Pairs, bEnd)
+			{
+			}
+
+			__forceinline const KeyType& Key() const { return (*this)->Key; }
+			__forceinline ValueType& Value() const { return (*this)->Value; }
+		};
+
+		class ConstIterator : public PairSetType::ConstIterator
+		{
+		public:
+			__forceinline ConstIterator(const FlatHashMap& InMap, bool bEnd = false)
+				: PairSetType::ConstIterator(InMap.Pairs, bEnd)
+			{
+			}
+
+			__forceinline const KeyType& Key() const { return (*this)->Key; }
+			__forceinline const ValueType& Value() const { return (*this)->Value; }
+		};
+
+		__forceinline Iterator CreateIterator()
+		{
+			return Iterator(*this);
+		}
+		__forceinline ConstIterator CreateConstIterator() const
+		{
+			return ConstIterator(*this);
+		}
+
+		/**
+		* DO NOT USE DIRECTLY
+		* STL-like iterators to enable range-based for loop support.
+		*/
+		__forceinline friend Iterator      begin(FlatHashMap& Map) { return Iterator(Map); }
+		__forceinline friend ConstIterator begin(const FlatHashMap& Map) { return ConstIterator(Map); }
+		__forceinline friend Iterator      end(FlatHashMap& Map) { return Iterator(Map, true); }
+		__forceinline friend ConstIterator end(const FlatHashMap& Map) { return ConstIterator(Map, true); }
+
+	private:
+		template <typename ArgType>
+		ValueType& FindOrAddImpl(uint32 KeyHash, ArgType&& Arg)
+		{
+			const uint64 Mixed = FlatHash_Private::MixHash(KeyHash);
+			const int32 Index = Pairs.FindIndex(Arg, Mixed);
+			if (Index != INDEX_NONE)
+			{
+				return Pairs.GetSlots()[Index].Value;
+			}
+
+			// Arg may be the key of another pair, build the new pair before growing the table can free it
+			TypeCompatibleBytes<ElementType> NewPairBytes;
+			new(&NewPairBytes) ElementType(KeyInitializer<ArgType&&>(Forward<ArgType>(Arg)));
+
+			ElementType* Slot = Pairs.InsertUninitialized(Mixed);
+			RelocateConstructItems<ElementType>(Slot, (ElementType*)&NewPairBytes, 1);
+			return Slot->Value;
+		}
+
+		PairSetType Pairs;
+	};
+}
@@ -0,0 +1,445 @@
+#pragma once
+
+#include "../Core/Types.h"
+#include "../Core/Memory.h"
+#include "../Core/Template.h"
+#include "AllocationPolicies.h"
+#include "../Windows/Atomics.h"
+#include "../Core/PlatformAtomics.h"
+
+#include <new>
+
+namespace EDX
+{
+	namespace LockFree_Private
+	{
+#if PLATFORM_HAS_128BIT_CAS
+		/**
+		* Pointer and 64-bit ABA counter side by side in 128 bits, swapped together with cmpxchg16b.
+		*
+		* The counter never wraps in practice, so a node popped and pushed back any number of times between the load of
+		* the head and the CAS can't make the CAS succeed.
+		*/
+		struct TaggedPointer
+		{
+			typedef Int128 PackedType;
+
+			static __forceinline PackedType Pack(const void* Ptr, uint64 Tag)
+			{
+				PackedType Packed;
+				Packed.Low = int64(UPTRINT(Ptr));
+				Packed.High = int64(Tag);
+				return Packed;
+			}
+
+			template<typename T>
+			static __forceinline T* GetPointer(const PackedType& Packed)
+			{
+				return (T*)UPTRINT(Packed.Low);
+			}
+
+			static __forceinline uint64 GetTag(const PackedType& Packed)
+			{
+				return uint64(Packed.High);
+			}
+
+			/** Plain reads of both halves, a torn value only makes the following CAS fail. */
+			static __forceinline PackedType Load(const volatile PackedType& Head)
+			{
+				PackedType Packed;
+				Packed.High = Head.High;
+				Packed.Low = Head.Low;
+				return Packed;
+			}
+
+			static __forceinline bool CompareExchange(volatile PackedType* Dest, PackedType Expected, const PackedType& Desired)
+			{
+				return PlatformAtomics::CompareExchange128(Dest, Expected, Desired);
+			}
+		};
+#else
+		/**
+		* Pointer and ABA counter packed into a single 64-bit word, so both can be swapped with one CAS.
+		*
+		* On 32-bit targets the pointer and the counter get 32 bits each. 64-bit targets without a double-width CAS
+		* keep the low 48 bits for user mode addresses, leaving only 16 bits for the counter, which wraps after
+		* 65536 updates of the head.
+		*/
+		struct TaggedPointer
+		{
+			typedef int64 PackedType;
+
+#if defined(_WIN64)
+			enum { PointerBits = 48 };
+#else
+			enum { PointerBits = 32 };
+#endif
+			static const uint64 PointerMask = (uint64(1) << PointerBits) - 1;
+
+			static __forceinline PackedType Pack(const void* Ptr, uint64 Tag)
+			{
+				return PackedType((uint64(UPTRINT(Ptr)) & PointerMask) | (Tag << PointerBits));
+			}
+
+			template<typename T>
+			static __forceinline T* GetPointer(PackedType Packed)
+			{
+				return (T*)UPTRINT(uint64(Packed) & PointerMask);
+			}
+
+			static __forceinline uint64 GetTag(PackedType Packed)
+			{
+				return uint64(Packed) >> PointerBits;
+			}
+
+			static __forceinline PackedType Load(const volatile PackedType& Head)
+			{
+				return Head;
+			}
+
+			static __forceinline bool CompareExchange(volatile PackedType* Dest, PackedType Expected, PackedType Desired)
+			{
+				return WindowsAtomics::InterlockedCompareExchange(Dest, Desired, Expected) == Expected;
+			}
+		};
+#endif
+	}
+
+	/**
+	* Template for intrusive lock-free stacks.
+	*
+	* The links are stored in the nodes themselves: NodeType must have a "NodeType* Next" member, which the stack owns
+	* while the node is pushed. Every head update bumps an ABA counter swapped together with the head pointer, 64 bits
+	* wide where the platform has a 128-bit CAS.
+	*
+	* Pop reads the Next member of a node that may have been popped concurrently by another thread, so the memory of
+	* popped nodes must stay readable as long as the stack is in use (e.g. recycle nodes through another stack or a pool
+	* instead of returning them to the OS).
+	*
+	* @param NodeType The type of the nodes, must have a NodeType* Next member.
+	*/
+	template<typename NodeType>
+	class IntrusiveLockFreeStack
+	{
+	private:
+		typedef LockFree_Private::TaggedPointer TaggedPointer;
+		typedef TaggedPointer::PackedType PackedType;
+
+		/** Holds the head pointer and ABA counter. */
+		__declspec(align(16)) volatile PackedType Head;
+
+	public:
+
+		/** Default constructor. */
+		IntrusiveLockFreeStack()
+			: Head()
+		{
+		}
+
+		// Non-copyable
+		IntrusiveLockFreeStack(const IntrusiveLockFreeStack&) = delete;
+		IntrusiveLockFreeStack& operator=(const IntrusiveLockFreeStack&) = delete;
+
+		/**
+		* Pushes a node on top of the stack.
+		*
+		* @param Node The node to push.
+		* @see Pop, PushChain
+		*/
+		__forceinline void Push(NodeType* Node)
+		{
+			PushChain(Node, Node);
+		}
+
+		/**
+		* Pushes a chain of nodes linked through their Next members with a single CAS. First ends up on top of the stack.
+		*
+		* @param First The first node of the chain.
+		* @param Last The last node of the chain, its Next member is overwritten.
+		* @see Push, PopAll
+		*/
+		void PushChain(NodeType* First, NodeType* Last)
+		{
+			Assert(First && Last);
+
+			for (;;)
+			{
+				const PackedType OldHead = TaggedPointer::Load(Head);
+				Last->Next = TaggedPointer::GetPointer<NodeType>(OldHead);
+
+				const PackedType NewHead = TaggedPointer::Pack(First, TaggedPointer::GetTag(OldHead) + 1);
+				if (TaggedPointer::CompareExchange(&Head, OldHead, NewHead))
+				{
+					return;
+				}
+			}
+		}
+
+		/**
+		* Pops the node on top of the stack.
+		*
+		* @return the popped node, or nullptr if the stack was empty.
+		* @see Push, PopAll
+		*/
+		NodeType* Pop()
+		{
+			for (;;)
+			{
+				const PackedType OldHead = TaggedPointer::Load(Head);
+				NodeType* Node = TaggedPointer::GetPointer<NodeType>(OldHead);
+				if (Node == nullptr)
+				{
+					return nullptr;
+				}
+
+				// May read a node popped by another thread in between, the tag makes the CAS fail in that case
+				const PackedType NewHead = TaggedPointer::Pack(Node->Next, TaggedPointer::GetTag(OldHead) + 1);
+				if (TaggedPointer::CompareExchange(&Head, OldHead, NewHead))
+				{
+					return Node;
+				}
+			}
+		}
+
+		/**
+		* Detaches the whole stack with a single CAS.
+		*
+		* @return the former top node, the rest of the chain follows through the Next members. nullptr if the stack was empty.
+		* @see Pop, PushChain
+		*/
+		NodeType* PopAll()
+		{
+			for (;;)
+			{
+				const PackedType OldHead = TaggedPointer::Load(Head);
+				NodeType* Node = TaggedPointer::GetPointer<NodeType>(OldHead);
+				if (Node == nullptr)
+				{
+					return nullptr;
+				}
+
+				const PackedType NewHead = TaggedPointer::Pack(nullptr, TaggedPointer::GetTag(OldHead) + 1);
+				if (TaggedPointer::CompareExchange(&Head, OldHead, NewHead))
+				{
+					return Node;
+				}
+			}
+		}
+
+		/**
+		* Checks whether the stack is empty. The result may be outdated by the time it's returned.
+		*
+		* @return true if the stack is empty, false otherwise.
+		*/
+		bool IsEmpty() const
+		{
+			return TaggedPointer::GetPointer<NodeType>(TaggedPointer::Load(Head)) == nullptr;
+		}
+	};
+
+
+	/**
+	* Template for lock-free stacks.
+	*
+	* This template implements an unbounded non-intrusive stack that stores copies of the pushed items. Nodes are
+	* never returned to the heap while the stack is alive, they are recycled through an internal free stack, which is
+	* what makes the intrusive Pop safe.
+	*
+	* @param ItemType The type of items stored in the stack.
+	*/
+	template<typename ItemType>
+	class LockFreeStack
+	{
+	private:
+		/** Structure for the internal linked list. */
+		struct Node
+		{
+			/** Holds a pointer to the next node in the list. */
+			Node* Next;
+
+			/** Holds the node's item. */
+			TypeCompatibleBytes<ItemType> Item;
+
+			ItemType* GetItem()
+			{
+				return (ItemType*)&Item;
+			}
+		};
+
+		/** Holds the pushed items. */
+		__declspec(align(PLATFORM_CACHE_LINE_SIZE)) IntrusiveLockFreeStack<Node> Items;
+
+		/** Holds nodes ready to be reused. */
+		__declspec(align(PLATFORM_CACHE_LINE_SIZE)) IntrusiveLockFreeStack<Node> FreeNodes;
+
+	public:
+
+		/** Default constructor. */
+		LockFreeStack()
+		{
+		}
+
+		// Non-copyable
+		LockFreeStack(const LockFreeStack&) = delete;
+		LockFreeStack& operator=(const LockFreeStack&) = delete;
+
+		/** Destructor. */
+		~LockFreeStack()
+		{
+			Clear();
+
+			Node* Free = FreeNodes.PopAll();
+			while (Free)
+			{
+				Node* Next = Free->Next;
+				Memory::Free(Free);
+				Free = Next;
+			}
+		}
+
+	public:
+
+		/**
+		* Pushes an item on top of the stack.
+		*
+		* @param Item The item to add.
+		* @see Pop, PushRange
+		*/
+		void Push(const ItemType& Item)
+		{
+			Node* NewNode = AllocNode();
+			new(NewNode->GetItem()) ItemType(Item);
+
+			Items.Push(NewNode);
+		}
+
+		void Push(ItemType&& Item)
+		{
+			Node* NewNode = AllocNode();
+			new(NewNode->GetItem()) ItemType(Move(Item));
+
+			Items.Push(NewNode);
+		}
+
+		/**
+		* Pushes a range of items with a single CAS on the stack head. The last item of the range ends up on top.
+		*
+		* @param InItems Pointer to the first item.
+		* @param Count Number of items to push.
+		* @see Push, PopAll
+		*/
+		void PushRange(const ItemType* InItems, int32 Count)
+		{
+			if (Count <= 0)
+			{
+				return;
+			}
+
+			Node* Last = nullptr;
+			Node* First = nullptr;
+			for (int32 i = 0; i < Count; i++)
+			{
+				Node* NewNode = AllocNode();
+				new(NewNode->GetItem()) ItemType(InItems[i]);
+
+				NewNode->Next = First;
+				First = NewNode;
+				if (Last == nullptr)
+				{
+					Last = NewNode;
+				}
+			}
+
+			Items.PushChain(First, Last);
+		}
+
+		/**
+		* Removes the item on top of the stack.
+		*
+		* @param OutItem Will hold the popped item.
+		* @return true if an item was returned, false if the stack was empty.
+		* @see Push, PopAll
+		*/
+		bool Pop(ItemType& OutItem)
+		{
+			Node* Popped = Items.Pop();
+			if (Popped == nullptr)
+			{
+				return false;
+			}
+
+			OutItem = Move(*Popped->GetItem());
+			FreeNode(Popped);
+
+			return true;
+		}
+
+		/**
+		* Removes all items with a single CAS on the stack head and passes them to Func, from top to bottom.
+		*
+		* @param Func Callable taking an ItemType&.
+		* @return the number of items removed.
+		* @see Pop, PushRange
+		*/
+		template<typename FuncType>
+		int32 PopAll(FuncType Func)
+		{
+			Node* Popped = Items.PopAll();
+			if (Popped == nullptr)
+			{
+				return 0;
+			}
+
+			int32 Count = 0;
+			Node* Last = Popped;
+			for (Node* It = Popped; It; It = It->Next)
+			{
+				Func(*It->GetItem());
+				DestructItems(It->GetItem(), 1);
+
+				Last = It;
+				Count++;
+			}
+
+			// Hand the whole chain back to the free list at once
+			FreeNodes.PushChain(Popped, Last);
+
+			return Count;
+		}
+
+		/** Empty the stack, discarding all items. */
+		void Clear()
+		{
+			PopAll([](ItemType&) {});
+		}
+
+		/**
+		* Checks whether the stack is empty. The result may be outdated by the time it's returned.
+		*
+		* @return true if the stack is empty, false otherwise.
+		*/
+		bool IsEmpty() const
+		{
+			return Items.IsEmpty();
+		}
+
+	private:
+		__forceinline Node* AllocNode()
+		{
+			Node* NewNode = FreeNodes.Pop();
+			if (NewNode == nullptr)
+			{
+				NewNode = (Node*)Memory::AlignedAlloc(sizeof(Node), ALIGNOF(Node));
+			}
+
+			return NewNode;
+		}
+
+		__forceinline void FreeNode(Node* InNode)
+		{
+			DestructItems(InNode->GetItem(), 1);
+			FreeNodes.Push(InNode);
+		}
+	};
+
+}
@@ -114,6 +114,11 @@ namespace EDX
 		{
 			return A == B;
 		}
+		template<typename ComparableKey>
+		static __forceinline bool Matches(KeyInitType A, const ComparableKey& B)
+		{
+			return A == B;
+		}
 		static __forceinline uint32 GetKeyHash(KeyInitType Key)
 		{
 			return GetTypeHash(Key);
@@ -260,6 +265,18 @@ namespace EDX
 			Pairs.Reserve(Number);
 		}
 
+		/**
+		* Replaces the contents of the map with InPairs, built in bulk with Set::BuildFrom. Much faster than adding
+		* the pairs one by one for large tables; unless the map allows duplicate keys, later pairs win.
+		* @param InPairs - The pairs to move into the map, left empty.
+		* @param bParallel - Hashes the keys of large inputs in parallel, see Set::BuildFrom.
+		*/
+		template<typename ArrayAllocator>
+		__forceinline void BuildFrom(Array<PairType, ArrayAllocator>&& InPairs, bool bParallel = false)
+		{
+			Pairs.BuildFrom(Move(InPairs), bParallel);
+		}
+
 		/** @return The number of elements in the map. */
 		__forceinline int32 Size() const
 		{
@@ -350,6 +367,20 @@ namespace EDX
 			return Pairs[PairId].Value;
 		}
 
+		/**
+		* Sets the value associated with a key, using a hash of the key the caller already has.
+		*
+		* @param KeyHash - Must be KeyFuncs::GetKeyHash of InKey.
+		* @return A reference to the value as stored in the map.  The reference is only valid until the next change to any key in the map.
+		*/
+		template <typename InitKeyType, typename InitValueType>
+		ValueType& AddByHash(uint32 KeyHash, InitKeyType&& InKey, InitValueType&& InValue)
+		{
+			const SetElementId PairId = Pairs.EmplaceByHash(KeyHash, PairInitializer<InitKeyType&&, InitValueType&&>(Forward<InitKeyType>(InKey), Forward<InitValueType>(InValue)));
+
+			return Pairs[PairId].Value;
+		}
+
 		/**
 		* Removes all value associations for a key.
 		* @param InKey - The key to remove associated values for.
@@ -361,6 +392,16 @@ namespace EDX
 			return NumRemovedPairs;
 		}
 
+		/**
+		* Removes all value associations for a key, using a hash of the key the caller already has. See FindByHash.
+		* @return The number of values that were associated with the key.
+		*/
+		template<typename ComparableKey>
+		__forceinline int32 RemoveByHash(uint32 KeyHash, const ComparableKey& Key)
+		{
+			return Pairs.RemoveByHash(KeyHash, Key);
+		}
+
 		/**
 		* Returns the key associated with the specified value.  The time taken is O(N) in the number of pairs.
 		* @param	Value - The value to search for
@@ -399,20 +440,46 @@ namespace EDX
 			return const_cast<MapBase*>(this)->Find(Key);
 		}
 
+		/**
+		* Returns the value associated with a specified key, using a hash of the key the caller already has.
+		*
+		* The key can be of any type KeyFuncs::Matches accepts, e.g. a const TCHAR* for a map keyed by String with the
+		* default KeyFuncs, so no temporary key is built: Map.FindByHash(GetTypeHash(Name), Name).
+		* @param	KeyHash - Must be the hash KeyFuncs::GetKeyHash gives for the equivalent key.
+		* @param	Key - The key to search for.
+		* @return	A pointer to the value associated with the specified key, or nullptr if the key isn't contained in this map.
+		*/
+		template<typename ComparableKey>
+		__forceinline ValueType* FindByHash(uint32 KeyHash, const ComparableKey& Key)
+		{
+			if (auto* Pair = Pairs.FindByHash(KeyHash, Key))
+			{
+				return &Pair->Value;
+			}
+
+			return nullptr;
+		}
+		template<typename ComparableKey>
+		__forceinline const ValueType* FindByHash(uint32 KeyHash, const ComparableKey& Key) const
+		{
+			return const_cast<MapBase*>(this)->FindByHash(KeyHash, Key);
+		}
+
 	private:
 		/**
 		* Returns the value associated with a specified key, or if none exists,
-		* adds a value using the default constructor.
+		* adds a value using the default constructor. The key is hashed once.
 		* @param	Key - The key to search for.
 		* @return	A reference to the value associated with the specified key.
 		*/
 		template <typename ArgType>
-		__forceinline ValueType& FindOrAddImpl(ArgType&& Arg)
+		__forceinline ValueType& FindOrAddImpl(uint32 KeyHash, ArgType&& Arg)
 		{
-			if (auto* Pair = Pairs.Find(Arg))
+			if (auto* Pair = Pairs.FindByHash(KeyHash, Arg))
 				return Pair->Value;
 
-			return Add(Forward<ArgType>(Arg));
+			const SetElementId PairId = Pairs.EmplaceByHash(KeyHash, KeyInitializer<ArgType&&>(Forward<ArgType>(Arg)));
+			return Pairs[PairId].Value;
 		}
 
 	public:
@@ -422,8 +489,15 @@ namespace EDX
 		* @param	Key - The key to search for.
 		* @return	A reference to the value associated with the specified key.
 		*/
-		__forceinline ValueType& FindOrAdd(const KeyType&  Key) { return FindOrAddImpl(Key); }
-		__forceinline ValueType& FindOrAdd(KeyType&& Key) { return FindOrAddImpl(Move(Key)); }
+		__forceinline ValueType& FindOrAdd(const KeyType&  Key) { return FindOrAddImpl(KeyFuncs::GetKeyHash(Key), Key); }
+		__forceinline ValueType& FindOrAdd(KeyType&& Key) { return FindOrAddImpl(KeyFuncs::GetKeyHash(Key), Move(Key)); }
+
+		/**
+		* Returns the value associated with a specified key, or if none exists, adds a value using the default constructor.
+		* @param	KeyHash - Must be KeyFuncs::GetKeyHash of Key.
+		*/
+		__forceinline ValueType& FindOrAddByHash(uint32 KeyHash, const KeyType&  Key) { return FindOrAddImpl(KeyHash, Key); }
+		__forceinline ValueType& FindOrAddByHash(uint32 KeyHash, KeyType&& Key) { return FindOrAddImpl(KeyHash, Move(Key)); }
 
 		/**
 		* Returns the value associated with a specified key, or if none exists,
@@ -494,6 +568,13 @@ namespace EDX
 			return Pairs.Contains(Key);
 		}
 
+		/** Checks if map contains the specified key, using a hash of the key the caller already has. See FindByHash. */
+		template<typename ComparableKey>
+		__forceinline bool ContainsByHash(uint32 KeyHash, const ComparableKey& Key) const
+		{
+			return Pairs.ContainsByHash(KeyHash, Key);
+		}
+
 		/**
 		* Generates an array from the keys in this map.
 		*/
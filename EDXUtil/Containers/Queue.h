@@ -1,6 +1,10 @@
 #pragma once
 
-#include "../Windows/Atomics.h"
+#include "../Core/Template.h"
+#include "../Core/PlatformAtomics.h"
+#include "AllocationPolicies.h"
+
+#include <new>
 
 namespace EDX
 {
@@ -28,6 +32,9 @@ namespace EDX
 	* writing it in a way that does not depend on possible instruction reordering on the CPU.
 	* The Enqueue() method uses an atomic compare-and-swap in multiple-producers scenarios.
 	*
+	* Items are constructed in place in their nodes, so ItemType doesn't need a default constructor as long as
+	* DequeueUninitialized is used instead of Dequeue. Every Enqueue allocates a node from the heap.
+	*
 	* @param ItemType The type of items stored in the queue.
 	* @param Mode The queue mode (single-producer, single-consumer by default).
 	* @todo gmp: Implement node pooling.
@@ -42,19 +49,18 @@ namespace EDX
 			/** Holds a pointer to the next node in the list. */
 			Node* volatile NextNode;
 
-			/** Holds the node's item. */
-			ItemType Item;
+			/** Holds the node's item, constructed only while the node is linked behind the tail. */
+			TypeCompatibleBytes<ItemType> Item;
 
 			/** Default constructor. */
 			Node()
 				: NextNode(nullptr)
 			{ }
 
-			/** Creates and initializes a new node. */
-			Node(const ItemType& InItem)
-				: NextNode(nullptr)
-				, Item(InItem)
-			{ }
+			ItemType* GetItem()
+			{
+				return (ItemType*)&Item;
+			}
 		};
 
 		/** Holds a pointer to the head of the list. */
@@ -78,13 +84,8 @@ namespace EDX
 		/** Destructor. */
 		~Queue()
 		{
-			while (Tail != nullptr)
-			{
-				Node* Node = Tail;
-				Tail = Tail->NextNode;
-
-				delete Node;
-			}
+			Clear();
+			delete Tail;
 		}
 
 	public:
@@ -98,19 +99,37 @@ namespace EDX
 		*/
 		bool Dequeue(ItemType& OutItem)
 		{
-			Node* Popped = Tail->NextNode;
+			Node* Popped = PopNode();
 
 			if (Popped == nullptr)
 			{
 				return false;
 			}
 
-			OutItem = Popped->Item;
+			OutItem = Move(*Popped->GetItem());
+			DestructItems(Popped->GetItem(), 1);
 
-			Node* OldTail = Tail;
-			Tail = Popped;
-			Tail->Item = ItemType();
-			delete OldTail;
+			return true;
+		}
+
+		/**
+		* Removes the item from the tail of the queue and move constructs it into uninitialized memory, for items
+		* without a default constructor.
+		*
+		* @param OutItem Will hold the returned value, the caller has to destruct it.
+		* @return true if a value was returned, false if the queue was empty and OutItem was left untouched.
+		* @see Dequeue
+		*/
+		bool DequeueUninitialized(TypeCompatibleBytes<ItemType>& OutItem)
+		{
+			Node* Popped = PopNode();
+
+			if (Popped == nullptr)
+			{
+				return false;
+			}
+
+			RelocateConstructItems<ItemType>((void*)&OutItem, Popped->GetItem(), 1);
 
 			return true;
 		}
@@ -118,8 +137,10 @@ namespace EDX
 		/** Empty the queue, discarding all items. */
 		void Clear()
 		{
-			ItemType DummyItem;
-			while (Dequeue(DummyItem));
+			while (Node* Popped = PopNode())
+			{
+				DestructItems(Popped->GetItem(), 1);
+			}
 		}
 
 		/**
@@ -131,26 +152,30 @@ namespace EDX
 		*/
 		bool Enqueue(const ItemType& Item)
 		{
-			Node* NewNode = new Node(Item);
+			Node* NewNode = new Node();
 
 			if (NewNode == nullptr)
 			{
 				return false;
 			}
 
-			Node* OldHead;
+			new(NewNode->GetItem()) ItemType(Item);
+			LinkNode(NewNode);
 
-			if (Mode == EQueueMode::Mpsc)
-			{
-				OldHead = (Node*)WindowsAtomics::InterlockedExchangePtr((void**)&Head, NewNode);
-			}
-			else
+			return true;
+		}
+
+		bool Enqueue(ItemType&& Item)
+		{
+			Node* NewNode = new Node();
+
+			if (NewNode == nullptr)
 			{
-				OldHead = Head;
-				Head = NewNode;
+				return false;
 			}
 
-			OldHead->NextNode = NewNode;
+			new(NewNode->GetItem()) ItemType(Move(Item));
+			LinkNode(NewNode);
 
 			return true;
 		}
@@ -163,7 +188,7 @@ namespace EDX
 		*/
 		bool IsEmpty() const
 		{
-			return (Tail->NextNode == nullptr);
+			return (PlatformAtomics::Load(&Tail->NextNode, EMemoryOrder::Acquire) == nullptr);
 		}
 
 		/**
@@ -175,15 +200,55 @@ namespace EDX
 		*/
 		bool Peek(ItemType& OutItem) const
 		{
-			if (Tail->NextNode == nullptr)
+			Node* Next = PlatformAtomics::Load(&Tail->NextNode, EMemoryOrder::Acquire);
+			if (Next == nullptr)
 			{
 				return false;
 			}
 
-			OutItem = Tail->NextNode->Item;
+			OutItem = *Next->GetItem();
 
 			return true;
 		}
+
+	private:
+		void LinkNode(Node* NewNode)
+		{
+			Node* OldHead;
+
+			if (Mode == EQueueMode::Mpsc)
+			{
+				OldHead = PlatformAtomics::Exchange(&Head, NewNode, EMemoryOrder::AcquireRelease);
+			}
+			else
+			{
+				OldHead = Head;
+				Head = NewNode;
+			}
+
+			PlatformAtomics::Store(&OldHead->NextNode, NewNode, EMemoryOrder::Release);
+		}
+
+		/**
+		* Unlinks the node after the tail, which becomes the new tail, and frees the old one.
+		* @return the node holding the dequeued item, nullptr if the queue is empty. Its item still has to be moved out and destructed.
+		*/
+		Node* PopNode()
+		{
+			// Pairs with the release store in Enqueue, so the item is visible once the link is
+			Node* Popped = PlatformAtomics::Load(&Tail->NextNode, EMemoryOrder::Acquire);
+
+			if (Popped == nullptr)
+			{
+				return nullptr;
+			}
+
+			Node* OldTail = Tail;
+			Tail = Popped;
+			delete OldTail;
+
+			return Popped;
+		}
 	};
 
 }
\ No newline at end of file
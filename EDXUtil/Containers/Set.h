@@ -7,6 +7,7 @@
 #include "../Core/Sorting.h"
 #include "../Core/Misc.h"
 #include <initializer_list>
+#include <ppl.h>
 
 namespace EDX
 {
@@ -50,6 +51,15 @@ namespace EDX
 			return A == B;
 		}
 
+		/**
+		* @return True if the key matches a key of another type comparable with it, e.g. a String and a const TCHAR*.
+		*/
+		template<typename ComparableKey>
+		static __forceinline bool Matches(KeyInitType A, const ComparableKey& B)
+		{
+			return A == B;
+		}
+
 		/** Calculates a hash index for a key. */
 		static __forceinline uint32 GetKeyHash(KeyInitType Key)
 		{
@@ -210,7 +220,7 @@ namespace EDX
 		__forceinline explicit Set(Array<ElementType>&& InArray)
 			: HashSize(0)
 		{
-			Append(Move(InArray));
+			BuildFrom(Move(InArray));
 		}
 
 		/** Destructor. */
@@ -451,6 +461,17 @@ namespace EDX
 		__forceinline SetElementId Add(const InElementType&  InElement, bool* bIsAlreadyInSetPtr = NULL) { return Emplace(InElement, bIsAlreadyInSetPtr); }
 		__forceinline SetElementId Add(InElementType&& InElement, bool* bIsAlreadyInSetPtr = NULL) { return Emplace(Move(InElement), bIsAlreadyInSetPtr); }
 
+		/**
+		* Adds an element to the set, using a hash of its key the caller already has.
+		*
+		* @param	KeyHash						Must be KeyFuncs::GetKeyHash of the element's key
+		* @param	InElement					Element to add to set
+		* @param	bIsAlreadyInSetPtr	[out]	Optional pointer to bool that will be set depending on whether element is already in set
+		* @return	A pointer to the element stored in the set.
+		*/
+		__forceinline SetElementId AddByHash(uint32 KeyHash, const InElementType&  InElement, bool* bIsAlreadyInSetPtr = NULL) { return EmplaceByHash(KeyHash, InElement, bIsAlreadyInSetPtr); }
+		__forceinline SetElementId AddByHash(uint32 KeyHash, InElementType&& InElement, bool* bIsAlreadyInSetPtr = NULL) { return EmplaceByHash(KeyHash, Move(InElement), bIsAlreadyInSetPtr); }
+
 		/**
 		* Adds an element to the set.
 		*
@@ -463,9 +484,33 @@ namespace EDX
 		{
 			// Create a new element.
 			SparseArrayAllocationInfo ElementAllocation = Elements.AddUninitialized();
-			SetElementId ElementId(ElementAllocation.Index);
 			auto& Element = *new(ElementAllocation) SetElementType(Forward<ArgsType>(Args));
 
+			return EmplaceImpl(KeyFuncs::GetKeyHash(KeyFuncs::GetSetKey(Element.Value)), Element, SetElementId(ElementAllocation.Index), bIsAlreadyInSetPtr);
+		}
+
+		/**
+		* Adds an element to the set, using a hash of its key the caller already has.
+		*
+		* @param	KeyHash						Must be KeyFuncs::GetKeyHash of the key of the constructed element
+		* @param	Args						The argument(s) to be forwarded to the set element's constructor.
+		* @param	bIsAlreadyInSetPtr	[out]	Optional pointer to bool that will be set depending on whether element is already in set
+		* @return	A pointer to the element stored in the set.
+		*/
+		template <typename ArgsType>
+		SetElementId EmplaceByHash(uint32 KeyHash, ArgsType&& Args, bool* bIsAlreadyInSetPtr = NULL)
+		{
+			// Create a new element.
+			SparseArrayAllocationInfo ElementAllocation = Elements.AddUninitialized();
+			auto& Element = *new(ElementAllocation) SetElementType(Forward<ArgsType>(Args));
+
+			return EmplaceImpl(KeyHash, Element, SetElementId(ElementAllocation.Index), bIsAlreadyInSetPtr);
+		}
+
+	private:
+		/** Hashes a newly constructed element, or replaces the existing element with the same key by it. */
+		SetElementId EmplaceImpl(uint32 KeyHash, SetElementType& Element, SetElementId ElementId, bool* bIsAlreadyInSetPtr)
+		{
 			bool bIsAlreadyInSet = false;
 			if (!KeyFuncs::bAllowDuplicateKeys)
 			{
@@ -474,7 +519,7 @@ namespace EDX
 				// Don't bother searching for a duplicate if this is the first element we're adding
 				if (Elements.Size() != 1)
 				{
-					SetElementId ExistingId = FindId(KeyFuncs::GetSetKey(Element.Value));
+					SetElementId ExistingId = FindIdByHash(KeyHash, KeyFuncs::GetSetKey(Element.Value));
 					bIsAlreadyInSet = ExistingId.IsValidId();
 					if (bIsAlreadyInSet)
 					{
@@ -496,7 +541,7 @@ namespace EDX
 				if (!ConditionalRehash(Elements.Size()))
 				{
 					// If the rehash didn't add the new element to the hash, add it.
-					HashElement(ElementId, Element);
+					HashElement(ElementId, Element, KeyHash);
 				}
 			}
 
@@ -508,6 +553,8 @@ namespace EDX
 			return ElementId;
 		}
 
+	public:
+
 		template<typename ArrayAllocator>
 		void Append(const Array<ElementType, ArrayAllocator>& InElements)
 		{
@@ -563,6 +610,73 @@ namespace EDX
 			}
 		}
 
+		/**
+		* Replaces the contents of the set with InElements, built in bulk: the hash is sized once for all of them and the
+		* buckets are linked in a single pass. Much faster than adding the elements one by one, which rehashes every time
+		* the set grows.
+		*
+		* Unless duplicate keys are allowed, a later element replaces an earlier one with the same key, as with Add.
+		* @param InElements - The elements to move into the set, left empty.
+		* @param bParallel - Hashes the keys of large inputs on the PPL workers. KeyFuncs::GetKeyHash must then be safe to
+		*                    call concurrently, and the caller must not hold locks that tasks run meanwhile on this thread may take.
+		*/
+		template<typename ArrayAllocator>
+		void BuildFrom(Array<ElementType, ArrayAllocator>&& InElements, bool bParallel = false)
+		{
+			const int32 NumElements = InElements.Size();
+
+			Elements.Clear(NumElements);
+			for (ElementType& Element : InElements)
+			{
+				new(Elements.AddUninitialized()) SetElementType(Move(Element));
+			}
+			InElements.Reset();
+
+			// Size the hash once for all the elements
+			Hash.ResizeAllocation(0, 0, sizeof(SetElementId));
+			HashSize = NumElements > 0 ? Allocator::GetNumberOfHashBuckets(NumElements) : 0;
+			if (!HashSize)
+			{
+				return;
+			}
+
+			Hash.ResizeAllocation(0, HashSize, sizeof(SetElementId));
+			for (int32 HashIndex = 0, LocalHashSize = HashSize; HashIndex < LocalHashSize; ++HashIndex)
+			{
+				GetTypedHash(HashIndex) = SetElementId();
+			}
+
+			ComputeHashIndices(bParallel);
+
+			// The elements are contiguous, link them in order so that later elements replace earlier ones
+			for (int32 Index = 0; Index < NumElements; ++Index)
+			{
+				SetElementType& Element = Elements[Index];
+				if (!KeyFuncs::bAllowDuplicateKeys)
+				{
+					bool bReplaced = false;
+					for (SetElementId ExistingId = GetTypedHash(Element.HashIndex); ExistingId.IsValidId(); ExistingId = Elements[ExistingId].HashNextId)
+					{
+						if (KeyFuncs::Matches(KeyFuncs::GetSetKey(Elements[ExistingId].Value), KeyFuncs::GetSetKey(Element.Value)))
+						{
+							MoveByRelocate(Elements[ExistingId].Value, Element.Value);
+							Elements.RemoveAtUninitialized(Index);
+							bReplaced = true;
+							break;
+						}
+					}
+
+					if (bReplaced)
+					{
+						continue;
+					}
+				}
+
+				Element.HashNextId = GetTypedHash(Element.HashIndex);
+				GetTypedHash(Element.HashIndex) = SetElementId(Index);
+			}
+		}
+
 		/**
 		* Removes an element from the set.
 		* @param Element - A pointer to the element in the set, as returned by Add or Find.
@@ -595,11 +709,26 @@ namespace EDX
 		* @param Key - The key to search for.
 		* @return The id of the set element matching the given key, or the NULL id if none matches.
 		*/
-		SetElementId FindId(KeyInitType Key) const
+		__forceinline SetElementId FindId(KeyInitType Key) const
+		{
+			return FindIdByHash(KeyFuncs::GetKeyHash(Key), Key);
+		}
+
+		/**
+		* Finds an element with the given key in the set, using a hash of the key the caller already has.
+		*
+		* The key can be of any type KeyFuncs::Matches accepts, e.g. a const TCHAR* for a set of String with the default
+		* KeyFuncs, which avoids building a temporary key.
+		* @param KeyHash - Must be the hash KeyFuncs::GetKeyHash gives for the equivalent key.
+		* @param Key - The key to search for.
+		* @return The id of the set element matching the given key, or the NULL id if none matches.
+		*/
+		template<typename ComparableKey>
+		SetElementId FindIdByHash(uint32 KeyHash, const ComparableKey& Key) const
 		{
 			if (Elements.Size())
 			{
-				for (SetElementId ElementId = GetTypedHash(KeyFuncs::GetKeyHash(Key));
+				for (SetElementId ElementId = GetTypedHash(KeyHash);
 					ElementId.IsValidId();
 					ElementId = Elements[ElementId].HashNextId)
 				{
@@ -649,18 +778,45 @@ namespace EDX
 			}
 		}
 
+		/**
+		* Finds an element with the given key in the set, using a hash of the key the caller already has. See FindIdByHash.
+		* @return A pointer to an element with the given key.  If no element in the set has the given key, this will return NULL.
+		*/
+		template<typename ComparableKey>
+		__forceinline ElementType* FindByHash(uint32 KeyHash, const ComparableKey& Key)
+		{
+			SetElementId ElementId = FindIdByHash(KeyHash, Key);
+			return ElementId.IsValidId() ? &Elements[ElementId].Value : NULL;
+		}
+		template<typename ComparableKey>
+		__forceinline const ElementType* FindByHash(uint32 KeyHash, const ComparableKey& Key) const
+		{
+			SetElementId ElementId = FindIdByHash(KeyHash, Key);
+			return ElementId.IsValidId() ? &Elements[ElementId].Value : NULL;
+		}
+
 		/**
 		* Removes all elements from the set matching the specified key.
 		* @param Key - The key to match elements against.
 		* @return The number of elements removed.
 		*/
-		int32 Remove(KeyInitType Key)
+		__forceinline int32 Remove(KeyInitType Key)
+		{
+			return RemoveByHash(KeyFuncs::GetKeyHash(Key), Key);
+		}
+
+		/**
+		* Removes all elements from the set matching the specified key, using a hash of the key the caller already has. See FindIdByHash.
+		* @return The number of elements removed.
+		*/
+		template<typename ComparableKey>
+		int32 RemoveByHash(uint32 KeyHash, const ComparableKey& Key)
 		{
 			int32 NumRemovedElements = 0;
 
 			if (Elements.Size())
 			{
-				SetElementId* NextElementId = &GetTypedHash(KeyFuncs::GetKeyHash(Key));
+				SetElementId* NextElementId = &GetTypedHash(KeyHash);
 				while (NextElementId->IsValidId())
 				{
 					auto& Element = Elements[*NextElementId];
@@ -697,6 +853,13 @@ namespace EDX
 			return FindId(Key).IsValidId();
 		}
 
+		/** Checks if the set contains an element with the given key, using a hash of the key the caller already has. See FindIdByHash. */
+		template<typename ComparableKey>
+		__forceinline bool ContainsByHash(uint32 KeyHash, const ComparableKey& Key) const
+		{
+			return FindIdByHash(KeyHash, Key).IsValidId();
+		}
+
 		/**
 		* Sorts the set's elements using the provided comparison class.
 		*/
@@ -966,9 +1129,15 @@ namespace EDX
 
 		/** Adds an element to the hash. */
 		__forceinline void HashElement(SetElementId ElementId, const SetElementType& Element) const
+		{
+			HashElement(ElementId, Element, KeyFuncs::GetKeyHash(KeyFuncs::GetSetKey(Element.Value)));
+		}
+
+		/** Adds an element to the hash, given the hash of its key. */
+		__forceinline void HashElement(SetElementId ElementId, const SetElementType& Element, uint32 KeyHash) const
 		{
 			// Compute the hash bucket the element goes in.
-			Element.HashIndex = KeyFuncs::GetKeyHash(KeyFuncs::GetSetKey(Element.Value)) & (HashSize - 1);
+			Element.HashIndex = KeyHash & (HashSize - 1);
 
 			// Link the element into the hash bucket.
 			Element.HashNextId = GetTypedHash(Element.HashIndex);
@@ -1027,6 +1196,39 @@ namespace EDX
 			}
 		}
 
+		/** BuildFrom hashes the keys in parallel, when asked to, from this many element slots and in parts of ParallelHashPartSize slots. */
+		enum { ParallelHashThreshold = 64 * 1024 };
+		enum { ParallelHashPartSize = 16 * 1024 };
+
+		/** Computes the hash bucket of every element for the current hash size, without linking them. */
+		void ComputeHashIndices(bool bParallel) const
+		{
+			const int32 MaxIndex = Elements.GetMaxIndex();
+			auto HashRange = [this](int32 Begin, int32 End)
+			{
+				for (int32 Index = Begin; Index < End; ++Index)
+				{
+					if (Elements.IsAllocated(Index))
+					{
+						const SetElementType& Element = Elements[Index];
+						Element.HashIndex = KeyFuncs::GetKeyHash(KeyFuncs::GetSetKey(Element.Value)) & (HashSize - 1);
+					}
+				}
+			};
+
+			if (!bParallel || MaxIndex < ParallelHashThreshold)
+			{
+				HashRange(0, MaxIndex);
+				return;
+			}
+
+			const int32 NumParts = (MaxIndex + ParallelHashPartSize - 1) / ParallelHashPartSize;
+			concurrency::parallel_for(0, NumParts, [&](int32 Part)
+			{
+				HashRange(Part * ParallelHashPartSize, Math::Min((Part + 1) * ParallelHashPartSize, MaxIndex));
+			});
+		}
+
 		/** The base type of whole set iterators. */
 		template<bool bConst>
 		class BaseIterator
@@ -0,0 +1,368 @@
+#pragma once
+
+#include "../Core/Types.h"
+#include "../Core/Template.h"
+#include "../Core/Sorting.h"
+#include "../Math/EDXMath.h"
+#include "Array.h"
+
+#include <xmmintrin.h>
+
+namespace EDX
+{
+	/**
+	* Read-mostly map from ordered keys to values, for tables built once and queried many times.
+	*
+	* Keys and values live in two separate contiguous arrays, no per element hash links. Pairs are appended with
+	* Add, then Freeze sorts them and lays both arrays out in Eytzinger (BFS) order: node k has its children at
+	* 2k and 2k+1, so the top of the implicit search tree shares a few cache lines and a lookup is a branchless
+	* descent that prefetches the cache line of its descendants four levels down. Lookups only read the key array.
+	*
+	* Besides exact lookups, the map answers lower/upper bound and range queries, walking the keys in order.
+	* Queries require a frozen map; Add unfreezes it, and a later Add replaces the value of an existing key once
+	* the map is frozen again.
+	*/
+	template<typename KeyType, typename ValueType, typename Allocator = DefaultAllocator, typename KeyLess = Less<KeyType>>
+	class SortedArrayMap
+	{
+		typedef typename TypeTraits<KeyType>::ConstInitType KeyInitType;
+
+		/** Distance, in nodes, to the descendants that fill the cache line prefetched at every step of a lookup. */
+		enum { PrefetchMultiplier = sizeof(KeyType) >= 64 ? 1 : 64 / sizeof(KeyType) };
+
+	public:
+		SortedArrayMap()
+			: bFrozen(true)
+		{
+		}
+
+		/**
+		* Appends a pair. The map needs to be frozen again before it can be queried.
+		* @return A reference to the value, only valid until the next change to the map.
+		*/
+		__forceinline ValueType& Add(const KeyType&  InKey, const ValueType&  InValue) { return Emplace(InKey, InValue); }
+		__forceinline ValueType& Add(const KeyType&  InKey, ValueType&& InValue) { return Emplace(InKey, Move(InValue)); }
+		__forceinline ValueType& Add(KeyType&& InKey, const ValueType&  InValue) { return Emplace(Move(InKey), InValue); }
+		__forceinline ValueType& Add(KeyType&& InKey, ValueType&& InValue) { return Emplace(Move(InKey), Move(InValue)); }
+
+		template <typename InitKeyType, typename InitValueType>
+		ValueType& Emplace(InitKeyType&& InKey, InitValueType&& InValue)
+		{
+			bFrozen = false;
+			new(Keys) KeyType(Forward<InitKeyType>(InKey));
+			return *new(Values) ValueType(Forward<InitValueType>(InValue));
+		}
+
+		/**
+		* Sorts the pairs added since the last freeze in, dropping all but the last pair added for every key, and
+		* switches to the search layout.
+		*/
+		void Freeze()
+		{
+			if (bFrozen)
+			{
+				return;
+			}
+
+			const int32 NumPairs = Keys.Size();
+
+			// Sort pair indices, equal keys by insertion order so that the last one can be kept
+			Array<int32> Order;
+			Order.AddUninitialized(NumPairs);
+			for (int32 i = 0; i < NumPairs; i++)
+			{
+				Order[i] = i;
+			}
+
+			const KeyType* KeyData = Keys.Data();
+			Sort(Order.Data(), NumPairs, [KeyData](int32 A, int32 B)
+			{
+				if (KeyLess()(KeyData[A], KeyData[B]))
+				{
+					return true;
+				}
+				return !KeyLess()(KeyData[B], KeyData[A]) && A < B;
+			});
+
+			int32 NumUnique = 0;
+			for (int32 i = 0; i < NumPairs; i++)
+			{
+				if (i + 1 < NumPairs && !KeyLess()(KeyData[Order[i]], KeyData[Order[i + 1]]))
+				{
+					continue;
+				}
+				Order[NumUnique++] = Order[i];
+			}
+
+			// Move every pair to its node, nodes take the sorted pairs in in-order traversal order
+			Array<KeyType, Allocator> NewKeys;
+			Array<ValueType, Allocator> NewValues;
+			NewKeys.AddUninitialized(NumUnique);
+			NewValues.AddUninitialized(NumUnique);
+
+			int32 SortedIndex = 0;
+			FillNodes(1, uint32(NumUnique), Order.Data(), SortedIndex, NewKeys.Data(), NewValues.Data());
+
+			Keys = Move(NewKeys);
+			Values = Move(NewValues);
+			bFrozen = true;
+		}
+
+		__forceinline bool IsFrozen() const
+		{
+			return bFrozen;
+		}
+
+		/** In key order iterator over a frozen map. */
+		template<bool bConst>
+		class BaseIterator
+		{
+		protected:
+			typedef typename ChooseClass<bConst, const SortedArrayMap, SortedArrayMap>::Result MapType;
+			typedef typename ChooseClass<bConst, const ValueType, ValueType>::Result ItValueType;
+
+		public:
+			__forceinline BaseIterator(MapType& InMap, uint32 InNode)
+				: TheMap(InMap)
+				, Node(InNode)
+			{
+			}
+
+			/** Advances to the in-order successor: leftmost node of the right subtree, or the first ancestor we are left of. */
+			__forceinline BaseIterator& operator++()
+			{
+				const uint32 Num = uint32(TheMap.Keys.Size());
+				if (2 * Node + 1 <= Num)
+				{
+					Node = 2 * Node + 1;
+					while (2 * Node <= Num)
+					{
+						Node *= 2;
+					}
+				}
+				else
+				{
+					Node >>= Math::CountTrailingZeros(~Node) + 1;
+				}
+				return *this;
+			}
+
+			/** conversion to "bool" returning true if the iterator is valid. */
+			__forceinline explicit operator bool() const
+			{
+				return Node != 0;
+			}
+			/** inverse of the "bool" operator */
+			__forceinline bool operator !() const
+			{
+				return Node == 0;
+			}
+
+			__forceinline friend bool operator==(const BaseIterator& Lhs, const BaseIterator& Rhs) { return &Lhs.TheMap == &Rhs.TheMap && Lhs.Node == Rhs.Node; }
+			__forceinline friend bool operator!=(const BaseIterator& Lhs, const BaseIterator& Rhs) { return &Lhs.TheMap != &Rhs.TheMap || Lhs.Node != Rhs.Node; }
+
+			__forceinline const KeyType& Key() const
+			{
+				return TheMap.Keys[Node - 1];
+			}
+			__forceinline ItValueType& Value() const
+			{
+				return TheMap.Values[Node - 1];
+			}
+
+		protected:
+			MapType& TheMap;
+
+			/** 1-based node index, 0 past the end. */
+			uint32 Node;
+		};
+
+		typedef BaseIterator<false> Iterator;
+		typedef BaseIterator<true>  ConstIterator;
+
+		/** @return An iterator to the smallest key. */
+		__forceinline Iterator CreateIterator()
+		{
+			return Iterator(*this, GetFirstNode());
+		}
+		__forceinline ConstIterator CreateConstIterator() const
+		{
+			return ConstIterator(*this, GetFirstNode());
+		}
+
+		/** @return An iterator to the first key not less than Key. */
+		__forceinline Iterator LowerBound(KeyInitType Key)
+		{
+			return Iterator(*this, LowerBoundNode(Key));
+		}
+		__forceinline ConstIterator LowerBound(KeyInitType Key) const
+		{
+			return ConstIterator(*this, LowerBoundNode(Key));
+		}
+
+		/** @return An iterator to the first key greater than Key. */
+		__forceinline Iterator UpperBound(KeyInitType Key)
+		{
+			return Iterator(*this, UpperBoundNode(Key));
+		}
+		__forceinline ConstIterator UpperBound(KeyInitType Key) const
+		{
+			return ConstIterator(*this, UpperBoundNode(Key));
+		}
+
+		/**
+		* Calls Func(Key, Value) for every pair with First <= Key < Last, in key order.
+		* @return The number of pairs visited.
+		*/
+		template<typename FuncType>
+		int32 ForEachInRange(KeyInitType First, KeyInitType Last, FuncType Func) const
+		{
+			int32 NumVisited = 0;
+			for (ConstIterator It = LowerBound(First); It && KeyLess()(It.Key(), Last); ++It)
+			{
+				Func(It.Key(), It.Value());
+				NumVisited++;
+			}
+			return NumVisited;
+		}
+
+		/**
+		* @return A pointer to the value associated with the specified key, or nullptr if the key isn't contained in this map.
+		*/
+		__forceinline ValueType* Find(KeyInitType Key)
+		{
+			const uint32 Node = LowerBoundNode(Key);
+			return Node != 0 && !KeyLess()(Key, Keys[Node - 1]) ? &Values[Node - 1] : nullptr;
+		}
+		__forceinline const ValueType* Find(KeyInitType Key) const
+		{
+			return const_cast<SortedArrayMap*>(this)->Find(Key);
+		}
+
+		__forceinline bool Contains(KeyInitType Key) const
+		{
+			return Find(Key) != nullptr;
+		}
+
+		/** @return The value associated with the specified key, or triggers an assertion if the key does not exist. */
+		__forceinline const ValueType& FindChecked(KeyInitType Key) const
+		{
+			const ValueType* Value = Find(Key);
+			Assert(Value != nullptr);
+			return *Value;
+		}
+		__forceinline ValueType& FindChecked(KeyInitType Key)
+		{
+			ValueType* Value = Find(Key);
+			Assert(Value != nullptr);
+			return *Value;
+		}
+
+		/** @return The value associated with the specified key, or the default value for the ValueType if the key isn't contained in this map. */
+		__forceinline ValueType FindRef(KeyInitType Key) const
+		{
+			const ValueType* Value = Find(Key);
+			return Value ? *Value : ValueType();
+		}
+
+		/** @return The number of pairs, including duplicate keys added since the last freeze. */
+		__forceinline int32 Size() const
+		{
+			return Keys.Size();
+		}
+
+		__forceinline void Reserve(int32 Number)
+		{
+			Keys.Reserve(Number);
+			Values.Reserve(Number);
+		}
+
+		/** Removes all pairs, potentially leaving space allocated for an expected number of pairs about to be added. */
+		void Clear(int32 ExpectedNumElements = 0)
+		{
+			Keys.Clear(ExpectedNumElements);
+			Values.Clear(ExpectedNumElements);
+			bFrozen = true;
+		}
+
+		__forceinline uint32 GetAllocatedSize() const
+		{
+			return Keys.GetAllocatedSize() + Values.GetAllocatedSize();
+		}
+
+	private:
+		/** In-order traversal of the implicit tree, giving node Node and its subtrees the next sorted pairs. */
+		void FillNodes(uint32 Node, uint32 Num, const int32* Order, int32& SortedIndex, KeyType* NewKeys, ValueType* NewValues)
+		{
+			if (Node > Num)
+			{
+				return;
+			}
+
+			FillNodes(2 * Node, Num, Order, SortedIndex, NewKeys, NewValues);
+
+			const int32 Source = Order[SortedIndex++];
+			new(NewKeys + Node - 1) KeyType(Move(Keys[Source]));
+			new(NewValues + Node - 1) ValueType(Move(Values[Source]));
+
+			FillNodes(2 * Node + 1, Num, Order, SortedIndex, NewKeys, NewValues);
+		}
+
+		__forceinline uint32 GetFirstNode() const
+		{
+			Assertf(bFrozen, EDX_TEXT("SortedArrayMap must be frozen before it is queried"));
+
+			const uint32 Num = uint32(Keys.Size());
+			if (Num == 0)
+			{
+				return 0;
+			}
+
+			uint32 Node = 1;
+			while (2 * Node <= Num)
+			{
+				Node *= 2;
+			}
+			return Node;
+		}
+
+		/** @return The node of the first key not less than Key (or, with bUpper, greater than Key), 0 if there is none. */
+		template<bool bUpper>
+		__forceinline uint32 SearchNode(KeyInitType Key) const
+		{
+			Assertf(bFrozen, EDX_TEXT("SortedArrayMap must be frozen before it is queried"));
+
+			const KeyType* KeyData = Keys.Data();
+			const uint32 Num = uint32(Keys.Size());
+
+			uint32 Node = 1;
+			while (Node <= Num)
+			{
+				_mm_prefetch((const char*)(KeyData + (PrefetchMultiplier * Node - 1)), _MM_HINT_T0);
+
+				// Go right past every key that is too small
+				const bool bRight = bUpper ? !KeyLess()(Key, KeyData[Node - 1]) : KeyLess()(KeyData[Node - 1], Key);
+				Node = 2 * Node + uint32(bRight);
+			}
+
+			// Undo the right turns taken after the last left one, and that left turn, to get to its node
+			return Node >> (Math::CountTrailingZeros(~Node) + 1);
+		}
+
+		__forceinline uint32 LowerBoundNode(KeyInitType Key) const
+		{
+			return SearchNode<false>(Key);
+		}
+
+		__forceinline uint32 UpperBoundNode(KeyInitType Key) const
+		{
+			return SearchNode<true>(Key);
+		}
+
+		/** Keys and values, in node order when frozen, node k at index k - 1. */
+		Array<KeyType, Allocator> Keys;
+		Array<ValueType, Allocator> Values;
+
+		bool bFrozen;
+	};
+}
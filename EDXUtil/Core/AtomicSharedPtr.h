@@ -0,0 +1,169 @@
+#pragma once
+
+#include "Types.h"
+#include "SmartPointer.h"
+#include "PlatformAtomics.h"
+#include "Reclamation.h"
+
+namespace EDX
+{
+	/**
+	* Shared pointer slot that can be read and replaced concurrently without locks, for publishing immutable
+	* snapshots (configurations, scenes) to many reader threads.
+	*
+	* The slot points to a small heap node owning one shared reference to the published object. Writers swap
+	* the node pointer with a single atomic operation and retire the old node to EpochReclamation, readers pin
+	* the epoch while they read the node, RCU style. A reader is never blocked by a writer nor by another reader.
+	*
+	* Load costs an epoch pin and one interlocked increment, Read only the epoch pin. Every Store allocates a
+	* node, so the slot suits data read much more often than it is replaced.
+	*
+	* Every publication also tries to advance the epoch, so the writer's next publication releases a replaced object
+	* once no reader uses it anymore, rather than after EpochReclamation::AdvanceInterval more retires on the writer
+	* thread. Call EpochReclamation::Flush on the writer thread to release it without publishing again.
+	*/
+	template<typename ObjectType>
+	class AtomicSharedPtr
+	{
+	public:
+		typedef SharedPtr<ObjectType, ESPMode::ThreadSafe> PtrType;
+
+	private:
+		/** Published node, immutable once stored in the slot. */
+		struct Snapshot
+		{
+			explicit Snapshot(const PtrType& InPtr)
+				: Ptr(InPtr)
+			{
+			}
+
+			PtrType Ptr;
+		};
+
+	public:
+		AtomicSharedPtr()
+			: Current(nullptr)
+		{
+		}
+
+		explicit AtomicSharedPtr(const PtrType& Initial)
+			: Current(NewSnapshot(Initial))
+		{
+		}
+
+		/** Must not race with any other access to the slot. Snapshots loaded from it stay valid. */
+		~AtomicSharedPtr()
+		{
+			delete Current;
+		}
+
+		AtomicSharedPtr(const AtomicSharedPtr&) = delete;
+		AtomicSharedPtr& operator=(const AtomicSharedPtr&) = delete;
+
+		/** @return a shared pointer to the currently published object */
+		PtrType Load() const
+		{
+			EpochGuard Guard;
+
+			// The node can't be reclaimed while the epoch is pinned, and it holds a reference to the object
+			const Snapshot* Observed = PlatformAtomics::Load(&Current, EMemoryOrder::Acquire);
+			return Observed ? Observed->Ptr : PtrType();
+		}
+
+		/**
+		* Calls Func with a pointer to the currently published object, nullptr if there is none, without touching
+		* its reference count. The pointer must not be kept past the call; use Load to hold on to the snapshot.
+		*/
+		template<typename FuncType>
+		void Read(const FuncType& Func) const
+		{
+			EpochGuard Guard;
+
+			const Snapshot* Observed = PlatformAtomics::Load(&Current, EMemoryOrder::Acquire);
+			Func(Observed ? (const ObjectType*)Observed->Ptr.Get() : (const ObjectType*)nullptr);
+		}
+
+		/** Publishes Desired. Readers still using the previous object keep it alive until they are done. */
+		void Store(const PtrType& Desired)
+		{
+			RetireSnapshot(PlatformAtomics::Exchange(&Current, NewSnapshot(Desired), EMemoryOrder::AcquireRelease));
+		}
+
+		/** Publishes Desired and returns the previously published object. */
+		PtrType Exchange(const PtrType& Desired)
+		{
+			EpochGuard Guard;
+
+			Snapshot* Previous = PlatformAtomics::Exchange(&Current, NewSnapshot(Desired), EMemoryOrder::AcquireRelease);
+			PtrType Result = Previous ? Previous->Ptr : PtrType();
+			RetireSnapshot(Previous);
+
+			return Result;
+		}
+
+		/**
+		* Publishes Desired if the slot currently publishes the same object as Expected. Objects are compared by
+		* address; Expected holds a reference to its object, so the address can't have been reused meanwhile.
+		*
+		* @return true if Desired was published, otherwise Expected is updated to the currently published object
+		*/
+		bool CompareExchange(PtrType& Expected, const PtrType& Desired)
+		{
+			EpochGuard Guard;
+
+			Snapshot* Observed = PlatformAtomics::Load(&Current, EMemoryOrder::Acquire);
+			Snapshot* Replacement = nullptr;
+			for (;;)
+			{
+				const ObjectType* ObservedObject = Observed ? Observed->Ptr.Get() : nullptr;
+				if (ObservedObject != Expected.Get())
+				{
+					// Never published, can be deleted right away
+					delete Replacement;
+
+					Expected = Observed ? Observed->Ptr : PtrType();
+					return false;
+				}
+
+				if (Replacement == nullptr && Desired.IsValid())
+				{
+					Replacement = NewSnapshot(Desired);
+				}
+
+				// On failure Observed is reloaded, another writer got in between
+				if (PlatformAtomics::CompareExchange(&Current, Observed, Replacement, EMemoryOrder::AcquireRelease))
+				{
+					RetireSnapshot(Observed);
+					return true;
+				}
+			}
+		}
+
+		/** @return true if no object is published. Only a hint when writers are active. */
+		bool IsNull() const
+		{
+			return PlatformAtomics::Load(&Current, EMemoryOrder::Relaxed) == nullptr;
+		}
+
+	private:
+		/** Null pointers are published as a null node, no allocation. */
+		static __forceinline Snapshot* NewSnapshot(const PtrType& Ptr)
+		{
+			return Ptr.IsValid() ? new Snapshot(Ptr) : nullptr;
+		}
+
+		static __forceinline void RetireSnapshot(Snapshot* Retired)
+		{
+			if (Retired)
+			{
+				// Readers may still be copying the reference out of it, the node and its reference go once they are done
+				EpochReclamation::RetireDelete(Retired);
+			}
+
+			// Writers may publish rarely, don't leave replaced snapshots in the limbo lists until the next retire interval
+			EpochReclamation::TryAdvance();
+		}
+
+		Snapshot* volatile Current;
+	};
+}
@@ -709,6 +709,282 @@ namespace EDX
 		return (bool)Func;
 	}
 
+	namespace Function_Private
+	{
+		/**
+		* Type erased operations on a callable owned by UniqueFunction.
+		*/
+		struct UniqueFunctionOps
+		{
+			/** Move constructs the callable held by the storage Src into the empty storage Dest, and destroys the source. */
+			void(*Relocate)(void* Dest, void* Src);
+
+			/** Destroys the callable held by the storage. */
+			void(*Destroy)(void* Storage);
+
+			/** True if the callable lives in the storage itself, otherwise the storage holds a pointer to it. */
+			bool bInline;
+		};
+
+		/**
+		* Operations for callables constructed in the inline storage of UniqueFunction.
+		*/
+		template <typename T>
+		struct UniqueFunction_InlineOps
+		{
+			template <typename... ArgTypes>
+			static T* Construct(void* Storage, ArgTypes&&... Args)
+			{
+				return new (Storage) T(Forward<ArgTypes>(Args)...);
+			}
+
+			static void Relocate(void* Dest, void* Src)
+			{
+				new (Dest) T(Move(*(T*)Src));
+				((T*)Src)->~T();
+			}
+
+			static void Destroy(void* Storage)
+			{
+				((T*)Storage)->~T();
+			}
+
+			static const UniqueFunctionOps Ops;
+		};
+
+		template <typename T>
+		const UniqueFunctionOps UniqueFunction_InlineOps<T>::Ops = { &UniqueFunction_InlineOps<T>::Relocate, &UniqueFunction_InlineOps<T>::Destroy, true };
+
+		/**
+		* Operations for callables too large for the inline storage, which then holds a pointer to a heap allocation.
+		*/
+		template <typename T>
+		struct UniqueFunction_HeapOps
+		{
+			template <typename... ArgTypes>
+			static T* Construct(void* Storage, ArgTypes&&... Args)
+			{
+				T* Obj = new (Memory::AlignedAlloc(sizeof(T), uint32(ALIGNOF(T)))) T(Forward<ArgTypes>(Args)...);
+				*(T**)Storage = Obj;
+
+				return Obj;
+			}
+
+			static void Relocate(void* Dest, void* Src)
+			{
+				*(T**)Dest = *(T**)Src;
+			}
+
+			static void Destroy(void* Storage)
+			{
+				T* Obj = *(T**)Storage;
+				Obj->~T();
+				Memory::Free(Obj);
+			}
+
+			static const UniqueFunctionOps Ops;
+		};
+
+		template <typename T>
+		const UniqueFunctionOps UniqueFunction_HeapOps<T>::Ops = { &UniqueFunction_HeapOps<T>::Relocate, &UniqueFunction_HeapOps<T>::Destroy, false };
+	}
+
+	/**
+	* UniqueFunction<FuncType, InlineBytes>
+	*
+	* Move-only version of Function.  Callables of up to InlineBytes bytes, with an alignment of up to 16, are
+	* stored inside the UniqueFunction object and never allocate; larger ones go to the heap.  As nothing is ever
+	* copied, the bound callable only needs to be movable, so lambdas can capture move-only state such as UniquePtr.
+	*
+	* Example:
+	*
+	* UniquePtr<Mesh> MeshPtr = LoadMesh();
+	* UniqueFunction<void()> Task = [Ptr = Move(MeshPtr)]() { Ptr->Process(); };
+	* UniqueFunction<void()> Queued = Move(Task);  // Task is now unbound
+	*/
+	template <typename FuncType, int32 InlineBytes = 32>
+	class UniqueFunction : public Function_Private::FunctionRefBase<UniqueFunction<FuncType, InlineBytes>, FuncType>
+	{
+		friend struct Function_Private::FunctionRefBase<UniqueFunction<FuncType, InlineBytes>, FuncType>;
+
+		typedef Function_Private::FunctionRefBase<UniqueFunction<FuncType, InlineBytes>, FuncType> Super;
+
+		static_assert(InlineBytes >= sizeof(void*), "UniqueFunction needs room for at least a pointer");
+
+		/** Selects the storage of a callable type. */
+		template <typename T>
+		struct OpsFor
+		{
+			typedef typename ChooseClass<
+				sizeof(T) <= InlineBytes && ALIGNOF(T) <= 16,
+				Function_Private::UniqueFunction_InlineOps<T>,
+				Function_Private::UniqueFunction_HeapOps<T>
+			>::Result Type;
+		};
+
+	public:
+		/**
+		* Default constructor.
+		*/
+		UniqueFunction(TYPE_OF_NULLPTR = nullptr)
+			: Super(NoInit)
+			, Ops(nullptr)
+		{
+			Super::Unset();
+		}
+
+		/**
+		* Constructor which binds a UniqueFunction to any function object, moving it in if it's an rvalue.
+		*/
+		template <typename FunctorType, typename = typename EnableIf<!AreTypesEqual<UniqueFunction, typename Decay<FunctorType>::Type>::Value>::Type>
+		UniqueFunction(FunctorType&& InFunc)
+			: Super(NoInit)
+		{
+			typedef typename Decay<FunctorType>::Type   DecayedFunctorType;
+			typedef typename OpsFor<DecayedFunctorType>::Type OpsType;
+
+			static_assert(!IsAFunctionRef<DecayedFunctorType>::Value, "Cannot construct a UniqueFunction from a FunctionRef");
+
+			DecayedFunctorType* NewObj = OpsType::Construct(&Storage, Forward<FunctorType>(InFunc));
+			Ops = &OpsType::Ops;
+			Super::Set(NewObj);
+		}
+
+		/**
+		* Move constructor.
+		*/
+		UniqueFunction(UniqueFunction&& Other)
+			: Super(NoInit)
+			, Ops(nullptr)
+		{
+			Super::Unset();
+			MoveFrom(Other);
+		}
+
+		UniqueFunction(const UniqueFunction&) = delete;
+		UniqueFunction& operator=(const UniqueFunction&) = delete;
+
+		/**
+		* Move assignment operator.
+		*/
+		UniqueFunction& operator=(UniqueFunction&& Other)
+		{
+			if (this != &Other)
+			{
+				Reset();
+				MoveFrom(Other);
+			}
+
+			return *this;
+		}
+
+		/**
+		* Nullptr assignment operator.
+		*/
+		UniqueFunction& operator=(TYPE_OF_NULLPTR)
+		{
+			Reset();
+			return *this;
+		}
+
+		/**
+		* Destructor.
+		*/
+		~UniqueFunction()
+		{
+			if (Ops)
+			{
+				Ops->Destroy(&Storage);
+			}
+		}
+
+		/**
+		* Tests if the UniqueFunction is callable.
+		*/
+		__forceinline explicit operator bool() const
+		{
+			return Ops != nullptr;
+		}
+
+	private:
+		/**
+		* Returns a pointer to the callable object - needed by FunctionRefBase.
+		*/
+		__forceinline void* GetPtr() const
+		{
+			if (!Ops)
+			{
+				return nullptr;
+			}
+
+			return Ops->bInline ? (void*)&Storage : *(void**)&Storage;
+		}
+
+		/** Destroys the bound callable, if any. */
+		void Reset()
+		{
+			if (Ops)
+			{
+				Ops->Destroy(&Storage);
+				Ops = nullptr;
+			}
+			Super::Unset();
+		}
+
+		/** Takes over the callable of Other, which must be unbound. */
+		void MoveFrom(UniqueFunction& Other)
+		{
+			if (Other.Ops)
+			{
+				Ops = Other.Ops;
+				Ops->Relocate(&Storage, &Other.Storage);
+				Super::CopyAndReseat(Other, GetPtr());
+
+				Other.Ops = nullptr;
+				Other.Unset();
+			}
+		}
+
+		const Function_Private::UniqueFunctionOps* Ops;
+		mutable AlignedBytes<InlineBytes, 16> Storage;
+	};
+
+	/**
+	* Nullptr equality operator.
+	*/
+	template <typename FuncType, int32 InlineBytes>
+	__forceinline bool operator==(TYPE_OF_NULLPTR, const UniqueFunction<FuncType, InlineBytes>& Func)
+	{
+		return !Func;
+	}
+
+	/**
+	* Nullptr equality operator.
+	*/
+	template <typename FuncType, int32 InlineBytes>
+	__forceinline bool operator==(const UniqueFunction<FuncType, InlineBytes>& Func, TYPE_OF_NULLPTR)
+	{
+		return !Func;
+	}
+
+	/**
+	* Nullptr inequality operator.
+	*/
+	template <typename FuncType, int32 InlineBytes>
+	__forceinline bool operator!=(TYPE_OF_NULLPTR, const UniqueFunction<FuncType, InlineBytes>& Func)
+	{
+		return (bool)Func;
+	}
+
+	/**
+	* Nullptr inequality operator.
+	*/
+	template <typename FuncType, int32 InlineBytes>
+	__forceinline bool operator!=(const UniqueFunction<FuncType, InlineBytes>& Func, TYPE_OF_NULLPTR)
+	{
+		return (bool)Func;
+	}
+
 }
 
 
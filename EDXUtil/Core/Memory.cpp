@@ -0,0 +1,299 @@
+
+#include "Memory.h"
+#include "../Windows/Base.h"
+#include "../Windows/ParallelFor.h"
+
+#include <immintrin.h>
+
+namespace EDX
+{
+	// Requests below this size go straight to the CRT
+	static const size_t BulkMinSize = 256;
+
+	// Requests from this size are split across threads when allowed, in parts of at least BulkParallelPartSize
+	static const size_t BulkParallelThreshold = 32 * 1024 * 1024;
+	static const size_t BulkParallelPartSize = 4 * 1024 * 1024;
+
+	static bool DetectAVX2()
+	{
+		int CpuInfo[4];
+		__cpuidex(CpuInfo, 0, 0);
+		if (CpuInfo[0] < 7)
+		{
+			return false;
+		}
+
+		// The OS must save the YMM registers, then check the AVX2 feature bit
+		__cpuidex(CpuInfo, 1, 0);
+		const bool bOSXSave = (CpuInfo[2] & (1 << 27)) != 0;
+		const bool bAVX = (CpuInfo[2] & (1 << 28)) != 0;
+		if (!bOSXSave || !bAVX || (_xgetbv(0) & 6) != 6)
+		{
+			return false;
+		}
+
+		__cpuidex(CpuInfo, 7, 0);
+		return (CpuInfo[1] & (1 << 5)) != 0;
+	}
+
+	/** @return the size of the largest cache level, 8MB if it can't be queried. */
+	static size_t DetectLastLevelCacheSize()
+	{
+		size_t CacheSize = 0;
+
+		DWORD BufferSize = 0;
+		::GetLogicalProcessorInformation(nullptr, &BufferSize);
+
+		SYSTEM_LOGICAL_PROCESSOR_INFORMATION* pInfos = (SYSTEM_LOGICAL_PROCESSOR_INFORMATION*)Memory::SystemMalloc(BufferSize);
+		if (pInfos && ::GetLogicalProcessorInformation(pInfos, &BufferSize))
+		{
+			const DWORD NumInfos = BufferSize / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION);
+			for (DWORD i = 0; i < NumInfos; i++)
+			{
+				if (pInfos[i].Relationship == RelationCache)
+				{
+					CacheSize = Math::Max(CacheSize, size_t(pInfos[i].Cache.Size));
+				}
+			}
+		}
+		Memory::SystemFree(pInfos);
+
+		return CacheSize ? CacheSize : 8 * 1024 * 1024;
+	}
+
+	static __forceinline bool HasAVX2()
+	{
+		static const bool bHasAVX2 = DetectAVX2();
+		return bHasAVX2;
+	}
+
+	size_t Memory::GetNonTemporalThreshold()
+	{
+		// Streaming pays off once the buffer would evict a good part of the last level cache anyway
+		static const size_t Threshold = DetectLastLevelCacheSize() / 2;
+		return Threshold;
+	}
+
+	/** Cached copy with 32-byte loads and stores. Count must be at least 32. */
+	static void CopyAVX2(uint8* Dest, const uint8* Src, size_t Count)
+	{
+		size_t i = 0;
+		for (; i + 128 <= Count; i += 128)
+		{
+			const __m256i A = _mm256_loadu_si256((const __m256i*)(Src + i));
+			const __m256i B = _mm256_loadu_si256((const __m256i*)(Src + i + 32));
+			const __m256i C = _mm256_loadu_si256((const __m256i*)(Src + i + 64));
+			const __m256i D = _mm256_loadu_si256((const __m256i*)(Src + i + 96));
+			_mm256_storeu_si256((__m256i*)(Dest + i), A);
+			_mm256_storeu_si256((__m256i*)(Dest + i + 32), B);
+			_mm256_storeu_si256((__m256i*)(Dest + i + 64), C);
+			_mm256_storeu_si256((__m256i*)(Dest + i + 96), D);
+		}
+		for (; i + 32 <= Count; i += 32)
+		{
+			_mm256_storeu_si256((__m256i*)(Dest + i), _mm256_loadu_si256((const __m256i*)(Src + i)));
+		}
+
+		// The last 32 bytes overlap what has been copied already
+		if (i < Count)
+		{
+			_mm256_storeu_si256((__m256i*)(Dest + Count - 32), _mm256_loadu_si256((const __m256i*)(Src + Count - 32)));
+		}
+		_mm256_zeroupper();
+	}
+
+	/** Cached fill with 32-byte stores. Count must be at least 32. */
+	static void SetAVX2(uint8* Dest, uint8 Char, size_t Count)
+	{
+		const __m256i Value = _mm256_set1_epi8(char(Char));
+
+		size_t i = 0;
+		for (; i + 128 <= Count; i += 128)
+		{
+			_mm256_storeu_si256((__m256i*)(Dest + i), Value);
+			_mm256_storeu_si256((__m256i*)(Dest + i + 32), Value);
+			_mm256_storeu_si256((__m256i*)(Dest + i + 64), Value);
+			_mm256_storeu_si256((__m256i*)(Dest + i + 96), Value);
+		}
+		for (; i + 32 <= Count; i += 32)
+		{
+			_mm256_storeu_si256((__m256i*)(Dest + i), Value);
+		}
+
+		if (i < Count)
+		{
+			_mm256_storeu_si256((__m256i*)(Dest + Count - 32), Value);
+		}
+		_mm256_zeroupper();
+	}
+
+	/** Copy bypassing the caches on the destination side. The unaligned head and the tail are copied regularly. */
+	static void CopyStreaming(uint8* Dest, const uint8* Src, size_t Count)
+	{
+		const size_t Head = Math::Min((32 - (UPTRINT(Dest) & 31)) & 31, Count);
+		memcpy(Dest, Src, Head);
+		Dest += Head;
+		Src += Head;
+		Count -= Head;
+
+		size_t i = 0;
+		if (HasAVX2())
+		{
+			for (; i + 128 <= Count; i += 128)
+			{
+				_mm_prefetch((const char*)(Src + i + 1024), _MM_HINT_NTA);
+				const __m256i A = _mm256_loadu_si256((const __m256i*)(Src + i));
+				const __m256i B = _mm256_loadu_si256((const __m256i*)(Src + i + 32));
+				const __m256i C = _mm256_loadu_si256((const __m256i*)(Src + i + 64));
+				const __m256i D = _mm256_loadu_si256((const __m256i*)(Src + i + 96));
+				_mm256_stream_si256((__m256i*)(Dest + i), A);
+				_mm256_stream_si256((__m256i*)(Dest + i + 32), B);
+				_mm256_stream_si256((__m256i*)(Dest + i + 64), C);
+				_mm256_stream_si256((__m256i*)(Dest + i + 96), D);
+			}
+			_mm256_zeroupper();
+		}
+		else
+		{
+			for (; i + 64 <= Count; i += 64)
+			{
+				_mm_prefetch((const char*)(Src + i + 1024), _MM_HINT_NTA);
+				const __m128i A = _mm_loadu_si128((const __m128i*)(Src + i));
+				const __m128i B = _mm_loadu_si128((const __m128i*)(Src + i + 16));
+				const __m128i C = _mm_loadu_si128((const __m128i*)(Src + i + 32));
+				const __m128i D = _mm_loadu_si128((const __m128i*)(Src + i + 48));
+				_mm_stream_si128((__m128i*)(Dest + i), A);
+				_mm_stream_si128((__m128i*)(Dest + i + 16), B);
+				_mm_stream_si128((__m128i*)(Dest + i + 32), C);
+				_mm_stream_si128((__m128i*)(Dest + i + 48), D);
+			}
+		}
+
+		// Order the streaming stores before anything that follows
+		_mm_sfence();
+
+		memcpy(Dest + i, Src + i, Count - i);
+	}
+
+	/** Fill bypassing the caches. The unaligned head and the tail are filled regularly. */
+	static void SetStreaming(uint8* Dest, uint8 Char, size_t Count)
+	{
+		const size_t Head = Math::Min((32 - (UPTRINT(Dest) & 31)) & 31, Count);
+		memset(Dest, Char, Head);
+		Dest += Head;
+		Count -= Head;
+
+		size_t i = 0;
+		if (HasAVX2())
+		{
+			const __m256i Value = _mm256_set1_epi8(char(Char));
+			for (; i + 128 <= Count; i += 128)
+			{
+				_mm256_stream_si256((__m256i*)(Dest + i), Value);
+				_mm256_stream_si256((__m256i*)(Dest + i + 32), Value);
+				_mm256_stream_si256((__m256i*)(Dest + i + 64), Value);
+				_mm256_stream_si256((__m256i*)(Dest + i + 96), Value);
+			}
+			_mm256_zeroupper();
+		}
+		else
+		{
+			const __m128i Value = _mm_set1_epi8(char(Char));
+			for (; i + 64 <= Count; i += 64)
+			{
+				_mm_stream_si128((__m128i*)(Dest + i), Value);
+				_mm_stream_si128((__m128i*)(Dest + i + 16), Value);
+				_mm_stream_si128((__m128i*)(Dest + i + 32), Value);
+				_mm_stream_si128((__m128i*)(Dest + i + 48), Value);
+			}
+		}
+
+		_mm_sfence();
+
+		memset(Dest + i, Char, Count - i);
+	}
+
+	static void CopyKernel(uint8* Dest, const uint8* Src, size_t Count, bool bNonTemporal)
+	{
+		if (bNonTemporal)
+		{
+			CopyStreaming(Dest, Src, Count);
+		}
+		else if (HasAVX2())
+		{
+			CopyAVX2(Dest, Src, Count);
+		}
+		else
+		{
+			memcpy(Dest, Src, Count);
+		}
+	}
+
+	static void SetKernel(uint8* Dest, uint8 Char, size_t Count, bool bNonTemporal)
+	{
+		if (bNonTemporal)
+		{
+			SetStreaming(Dest, Char, Count);
+		}
+		else if (HasAVX2())
+		{
+			SetAVX2(Dest, Char, Count);
+		}
+		else
+		{
+			memset(Dest, Char, Count);
+		}
+	}
+
+	void* Memory::BulkMemcpy(void* Dest, const void* Src, size_t Count, bool bParallel)
+	{
+		if (Count < BulkMinSize)
+		{
+			return memcpy(Dest, Src, Count);
+		}
+
+		uint8* pDest = (uint8*)Dest;
+		const uint8* pSrc = (const uint8*)Src;
+		const bool bNonTemporal = Count >= GetNonTemporalThreshold();
+
+		if (bParallel && Count >= BulkParallelThreshold)
+		{
+			// Same split as the first touch initialization, the destination pages are local to the copying threads
+			ParallelForStatic(Count, [&](size_t Begin, size_t End)
+			{
+				CopyKernel(pDest + Begin, pSrc + Begin, End - Begin, bNonTemporal);
+			}, BulkParallelPartSize);
+		}
+		else
+		{
+			CopyKernel(pDest, pSrc, Count, bNonTemporal);
+		}
+
+		return Dest;
+	}
+
+	void* Memory::BulkMemset(void* Dest, uint8 Char, size_t Count, bool bParallel)
+	{
+		if (Count < BulkMinSize)
+		{
+			return memset(Dest, Char, Count);
+		}
+
+		uint8* pDest = (uint8*)Dest;
+		const bool bNonTemporal = Count >= GetNonTemporalThreshold();
+
+		if (bParallel && Count >= BulkParallelThreshold)
+		{
+			ParallelForStatic(Count, [&](size_t Begin, size_t End)
+			{
+				SetKernel(pDest + Begin, Char, End - Begin, bNonTemporal);
+			}, BulkParallelPartSize);
+		}
+		else
+		{
+			SetKernel(pDest, Char, Count, bNonTemporal);
+		}
+
+		return Dest;
+	}
+}
@@ -3,6 +3,16 @@
 #include "../Core/Types.h"
 #include "../Math/EDXMath.h"
 #include "../Core/Assertion.h"
+#include "../Core/SmallObjectAllocator.h"
+#include "../Core/MemoryTracker.h"
+
+/**
+* Routes Memory::AlignedAlloc, AlignedRealloc and Free through SmallObjectAllocator for requests it can serve,
+* larger ones still go to the CRT aligned heap.
+*/
+#ifndef EDX_USE_SMALL_OBJECT_ALLOCATOR
+#define EDX_USE_SMALL_OBJECT_ALLOCATOR 0
+#endif
 
 namespace EDX
 {
@@ -67,6 +77,24 @@ namespace EDX
 			Memcpy(&Dest, &Src, sizeof(T));
 		}
 
+		//
+		// Bulk memory kernels, for buffers large enough that the way they go through the caches matters. Medium sizes
+		// use AVX2 when available, sizes from GetNonTemporalThreshold use streaming stores that bypass the caches,
+		// so the data isn't read back soon after. With bParallel set, very large buffers are split across the PPL
+		// worker threads. Small sizes simply forward to the CRT.
+		//
+
+		static void* BulkMemcpy(void* Dest, const void* Src, size_t Count, bool bParallel = false);
+		static void* BulkMemset(void* Dest, uint8 Char, size_t Count, bool bParallel = false);
+
+		static __forceinline void* BulkMemzero(void* Dest, size_t Count, bool bParallel = false)
+		{
+			return BulkMemset(Dest, 0, Count, bParallel);
+		}
+
+		/** @return the size from which bulk kernels bypass the caches, half the last level cache size. */
+		static size_t GetNonTemporalThreshold();
+
 		template <typename T>
 		static __forceinline void Valswap(T& A, T& B)
 		{
@@ -224,27 +252,91 @@ namespace EDX
 		//
 
 		static __forceinline void* AlignedAlloc(size_t Size, uint32 Alignment = DEFAULT_ALIGNMENT)
+		{
+			void* Result = BackendAlloc(Size, Alignment);
+#if EDX_TRACK_ALLOCATIONS
+			MemoryTracker::OnAlloc(Result, Size, EDX_RETURN_ADDRESS());
+#endif
+
+			return Result;
+		}
+
+		static void* AlignedRealloc(void* Ptr, size_t NewSize, uint32 Alignment = DEFAULT_ALIGNMENT)
+		{
+#if EDX_TRACK_ALLOCATIONS
+			MemoryTracker::OnFree(Ptr);
+#endif
+			void* Result = BackendRealloc(Ptr, NewSize, Alignment);
+#if EDX_TRACK_ALLOCATIONS
+			MemoryTracker::OnAlloc(Result, NewSize, EDX_RETURN_ADDRESS());
+#endif
+
+			return Result;
+		}
+
+		static void Free(void* Ptr)
+		{
+#if EDX_TRACK_ALLOCATIONS
+			MemoryTracker::OnFree(Ptr);
+#endif
+			BackendFree(Ptr);
+		}
+
+		// Allocation backends, without tracking
+
+		static __forceinline void* BackendAlloc(size_t Size, uint32 Alignment = DEFAULT_ALIGNMENT)
 		{
 			Alignment = Math::Max(Size >= 16 ? (uint32)16 : (uint32)8, Alignment);
 
-			void* Result = _aligned_malloc(Size, Alignment);
+#if EDX_USE_SMALL_OBJECT_ALLOCATOR
+			if (void* Small = SmallObjectAllocator::Malloc(Size, Alignment))
+			{
+				return Small;
+			}
+#endif
+
+			void* Result = _aligned_malloc(Size, GetHeapAlignment(Alignment));
 			Assert(Result);
 
 			return Result;
 		}
 
-		static void* AlignedRealloc(void* Ptr, size_t NewSize, uint32 Alignment = DEFAULT_ALIGNMENT)
+		static void* BackendRealloc(void* Ptr, size_t NewSize, uint32 Alignment = DEFAULT_ALIGNMENT)
 		{
 			void* Result;
 			Alignment = Math::Max(NewSize >= 16 ? (uint32)16 : (uint32)8, Alignment);
 
+#if EDX_USE_SMALL_OBJECT_ALLOCATOR
+			if (Ptr && SmallObjectAllocator::Owns(Ptr))
+			{
+				const size_t OldSize = SmallObjectAllocator::GetAllocSize(Ptr);
+				if (NewSize && NewSize <= OldSize && (UPTRINT(Ptr) & (Alignment - 1)) == 0)
+				{
+					return Ptr;
+				}
+
+				Result = NewSize ? BackendAlloc(NewSize, Alignment) : nullptr;
+				if (Result)
+				{
+					Memcpy(Result, Ptr, Math::Min(OldSize, NewSize));
+				}
+
+				SmallObjectAllocator::Free(Ptr);
+				return Result;
+			}
+			else if (Ptr == nullptr)
+			{
+				return NewSize ? BackendAlloc(NewSize, Alignment) : nullptr;
+			}
+#endif
+
 			if (Ptr && NewSize)
 			{
-				Result = _aligned_realloc(Ptr, NewSize, Alignment);
+				Result = _aligned_realloc(Ptr, NewSize, GetHeapAlignment(Alignment));
 			}
 			else if (Ptr == nullptr)
 			{
-				Result = _aligned_malloc(NewSize, Alignment);
+				Result = _aligned_malloc(NewSize, GetHeapAlignment(Alignment));
 			}
 			else
 			{
@@ -260,8 +352,16 @@ namespace EDX
 			return Result;
 		}
 
-		static void Free(void* Ptr)
+		static void BackendFree(void* Ptr)
 		{
+#if EDX_USE_SMALL_OBJECT_ALLOCATOR
+			if (SmallObjectAllocator::Owns(Ptr))
+			{
+				SmallObjectAllocator::Free(Ptr);
+				return;
+			}
+#endif
+
 			_aligned_free(Ptr);
 		}
 
@@ -270,21 +370,41 @@ namespace EDX
 		{
 			if (Ptr != nullptr)
 			{
-				_aligned_free((void*)Ptr);
+				Free((void*)Ptr);
 				Ptr = nullptr;
 			}
 		}
 
-		static size_t GetAllocSize(void* Ptr)
+		/**
+		* @return the number of bytes usable at Ptr, at least the size it was allocated with.
+		* @param Alignment The alignment Ptr was allocated with. Only debug builds need it, to measure heap blocks.
+		*/
+		static size_t GetAllocSize(void* Ptr, uint32 Alignment = DEFAULT_ALIGNMENT)
 		{
 			if (!Ptr)
 			{
 				return 0;
 			}
 
-			size_t SizeOut = _aligned_msize(Ptr, 16, 0); // Assumes alignment of 16
-
-			return SizeOut;
+#if EDX_USE_SMALL_OBJECT_ALLOCATOR
+			if (SmallObjectAllocator::Owns(Ptr))
+			{
+				return SmallObjectAllocator::GetAllocSize(Ptr);
+			}
+#endif
+
+#ifdef _DEBUG
+			// The debug CRT puts its own header in front of aligned blocks
+			return _aligned_msize(Ptr, GetHeapAlignment(Alignment), 0);
+#else
+			// The release CRT's _aligned_malloc stores the base of the underlying heap block in the pointer sized slot
+			// preceding the aligned address. Measuring from there also counts the tail of the heap block, which
+			// _aligned_msize leaves out.
+			void* const* pBaseSlot = (void* const*)(UPTRINT(Ptr) & ~(UPTRINT(sizeof(void*)) - 1)) - 1;
+			void* pBase = *pBaseSlot;
+
+			return _msize(pBase) - (UPTRINT(Ptr) - UPTRINT(pBase));
+#endif
 		}
 
 		/**
@@ -295,10 +415,40 @@ namespace EDX
 		*/
 		static size_t QuantizeSize(size_t Count, uint32 Alignment = DEFAULT_ALIGNMENT)
 		{
-			return Count;
+			if (Count == 0)
+			{
+				return 0;
+			}
+
+			Alignment = Math::Max(Count >= 16 ? (uint32)16 : (uint32)8, Alignment);
+
+#if EDX_USE_SMALL_OBJECT_ALLOCATOR
+			const int32 SizeClass = SmallObjectAllocator::GetSizeClass(Count, Alignment);
+			if (SizeClass != INDEX_NONE)
+			{
+				return SmallObjectAllocator::GetClassSize(SizeClass);
+			}
+#endif
+
+			// The CRT heap hands out blocks in multiples of two pointers, and _aligned_malloc adds a pointer plus the
+			// alignment padding in front. Grow the request up to the end of the block it would get anyway.
+			const size_t HeapGranularity = 2 * sizeof(void*);
+			const size_t Overhead = sizeof(void*) + GetHeapAlignment(Alignment) - 1;
+			const size_t BlockSize = (Count + Overhead + HeapGranularity - 1) & ~(HeapGranularity - 1);
+
+			return BlockSize - Overhead;
 		}
 
 
+		/**
+		* Alignment of the blocks taken from the CRT heap. At least 16 regardless of the block size, so that
+		* GetAllocSize can pass the same alignment to _aligned_msize without knowing the size.
+		*/
+		static __forceinline uint32 GetHeapAlignment(uint32 Alignment)
+		{
+			return Math::Max(Alignment, 16u);
+		}
+
 		template<class T>
 		static __forceinline void SafeDelete(T*& pPtr)
 		{
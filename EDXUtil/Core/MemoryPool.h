@@ -4,82 +4,419 @@
 
 namespace EDX
 {
-
+	/**
+	* Linear arena allocator.
+	*
+	* Allocations are carved out of fixed size blocks by bumping an offset, and are released all at once with FreeAll
+	* or back to a previously taken Mark with Rewind. Blocks are kept and reused after a rewind.
+	* Every Mark starts a new generation, which Rewind ends again. ArenaAllocator uses it to catch containers that grow
+	* past a mark taken after they were created, see ArenaAllocator.
+	* Requests larger than a quarter of the block size, or aligned beyond the block alignment, are served from the heap
+	* individually and tracked in a separate list, so they don't waste the tail of the current block nor end up recycled
+	* as regular blocks.
+	*/
 	class MemoryPool
 	{
+	public:
+		/** Position in the arena, see Mark and Rewind. */
+		struct Marker
+		{
+			int32 BlockIndex;
+			uint Offset;
+			int32 NumLargeAllocs;
+			SIZE_T LargeBytes;
+
+			/** Generation the mark was taken in, restored by Rewind. */
+			uint32 Generation;
+		};
+
 	private:
 		uint mBlockSize;
+		uint mBlockAlignment;
 		uint mCurrOffset;
-		_byte* mpCurrentBlock;
+		int32 mCurrBlock;
 
-		Array<_byte*> mUsedBlocks, mAvailableBlocks;
+		Array<_byte*> mBlocks;
+		Array<_byte*> mLargeAllocs;
+		SIZE_T mLargeBytes;
+
+		SIZE_T mHighWaterMark;
+
+		uint32 mGeneration;
+		uint32 mNumMarks;
 
 	public:
-		MemoryPool(uint uiSize = 32768)
+		MemoryPool(uint uiSize = 32768, uint uiBlockAlignment = 64)
+			: mBlockSize(uiSize)
+			, mBlockAlignment(uiBlockAlignment)
+			, mCurrOffset(0)
+			, mCurrBlock(0)
+			, mLargeBytes(0)
+			, mHighWaterMark(0)
+			, mGeneration(0)
+			, mNumMarks(0)
 		{
-			mBlockSize = uiSize;
-			mCurrOffset = 0;
-			mpCurrentBlock = Memory::AlignedAlloc<_byte>(mBlockSize, 64);
+			Assert(IsPowerOfTwo(mBlockAlignment));
+			mBlocks.Add(Memory::AlignedAlloc<_byte>(mBlockSize, mBlockAlignment));
 		}
 		~MemoryPool()
 		{
 			// Free all memories in the destructor
-			Memory::Free(mpCurrentBlock);
+			FreeAll();
 
-			for (uint i = 0; i < mUsedBlocks.Size(); i++)
+			for (int32 i = 0; i < mBlocks.Size(); i++)
 			{
-				Memory::Free(mUsedBlocks[i]);
+				Memory::Free(mBlocks[i]);
 			}
+		}
+
+		MemoryPool(const MemoryPool&) = delete;
+		MemoryPool& operator = (const MemoryPool&) = delete;
 
-			for (uint i = 0; i < mAvailableBlocks.Size(); i++)
+		/**
+		* Allocates uninitialized memory.
+		*
+		* @param Size Number of bytes
+		* @param Alignment Required alignment, a power of two. DEFAULT_ALIGNMENT aligns to 16 bytes
+		*/
+		inline void* Alloc(SIZE_T Size, uint32 Alignment)
+		{
+			Alignment = Math::Max(Alignment, 16u);
+			Assert(IsPowerOfTwo(Alignment));
+
+			if (Size > mBlockSize / 4 || Alignment > mBlockAlignment)
 			{
-				Memory::Free(mAvailableBlocks[i]);
+				return AllocLarge(Size, Alignment);
 			}
+
+			uint uiOffset = Align(mCurrOffset, Alignment);
+
+			// Handle situation where the current block is used up
+			if (uiOffset + Size > mBlockSize)
+			{
+				// Reuse blocks left over from a previous rewind before allocating new ones
+				mCurrBlock++;
+				if (mCurrBlock == mBlocks.Size())
+				{
+					mBlocks.Add(Memory::AlignedAlloc<_byte>(mBlockSize, mBlockAlignment));
+				}
+
+				uiOffset = 0;
+			}
+
+			void* pRet = mBlocks[mCurrBlock] + uiOffset;
+			mCurrOffset = uiOffset + uint(Size);
+
+			UpdateHighWaterMark();
+
+			return pRet;
 		}
 
 		template<class T>
 		inline T* Alloc(uint uiCount = 1)
 		{
-			// Calculate the size of requested memory in terms of byte
-			uint uiSize = uiCount * sizeof(T);
+			return (T*)Alloc(SIZE_T(uiCount) * sizeof(T), uint32(ALIGNOF(T)));
+		}
 
-			// Make it aligned to 16 byte
-			uiSize = (uiSize + 15) & (~15);
+		/**
+		* Resizes an allocation in place. Only possible for the most recent allocation of the current block, and only
+		* while it still fits in the block.
+		*
+		* @return true if Ptr is now NewSize bytes long, false if it was left untouched
+		*/
+		inline bool TryResize(void* Ptr, SIZE_T OldSize, SIZE_T NewSize)
+		{
+			_byte* pBlock = mBlocks[mCurrBlock];
+			if ((_byte*)Ptr + OldSize != pBlock + mCurrOffset || (_byte*)Ptr < pBlock)
+			{
+				return false;
+			}
 
-			// Handle situation where the current block is used up
-			if (mCurrOffset + uiSize > mBlockSize)
+			const SIZE_T Offset = (_byte*)Ptr - pBlock;
+			if (Offset + NewSize > mBlockSize)
+			{
+				return false;
+			}
+
+			mCurrOffset = uint(Offset + NewSize);
+			UpdateHighWaterMark();
+
+			return true;
+		}
+
+		/** @return the current position, to be passed to Rewind. Starts a new generation. */
+		inline Marker Mark()
+		{
+			Marker Result;
+			Result.BlockIndex = mCurrBlock;
+			Result.Offset = mCurrOffset;
+			Result.NumLargeAllocs = mLargeAllocs.Size();
+			Result.LargeBytes = mLargeBytes;
+			Result.Generation = mGeneration;
+
+			mGeneration = ++mNumMarks;
+
+			return Result;
+		}
+
+		/**
+		* Releases everything allocated since the given Mark was taken, and returns to the generation it was taken in.
+		* Rewinding to the same marker again is only safe if nothing allocated before the mark has grown meanwhile.
+		*/
+		inline void Rewind(const Marker& InMarker)
+		{
+			Assert(InMarker.BlockIndex < mCurrBlock || (InMarker.BlockIndex == mCurrBlock && InMarker.Offset <= mCurrOffset));
+			Assert(InMarker.NumLargeAllocs <= mLargeAllocs.Size());
+
+			for (int32 i = InMarker.NumLargeAllocs; i < mLargeAllocs.Size(); i++)
+			{
+				Memory::Free(mLargeAllocs[i]);
+			}
+			mLargeAllocs.RemoveAt(InMarker.NumLargeAllocs, mLargeAllocs.Size() - InMarker.NumLargeAllocs, false);
+			mLargeBytes = InMarker.LargeBytes;
+
+			mCurrBlock = InMarker.BlockIndex;
+			mCurrOffset = InMarker.Offset;
+			mGeneration = InMarker.Generation;
+		}
+
+		inline void FreeAll()
+		{
+			Marker Start = { 0, 0, 0, 0, 0 };
+			Rewind(Start);
+		}
+
+		/** @return the number of bytes currently handed out, including alignment padding and block tails. */
+		inline SIZE_T GetBytesUsed() const
+		{
+			return SIZE_T(mCurrBlock) * mBlockSize + mCurrOffset + mLargeBytes;
+		}
+
+		/** @return the highest value GetBytesUsed has reached. */
+		inline SIZE_T GetHighWaterMark() const
+		{
+			return mHighWaterMark;
+		}
+
+		/** @return the number of bytes allocated from the heap, used or not. */
+		inline SIZE_T GetBytesReserved() const
+		{
+			return SIZE_T(mBlocks.Size()) * mBlockSize + mLargeBytes;
+		}
+
+		/** @return the number of live allocations that didn't fit in a block. */
+		inline int32 GetNumLargeAllocs() const
+		{
+			return mLargeAllocs.Size();
+		}
+
+		/** @return the generation started by the latest Mark that hasn't been rewound, 0 before any. */
+		inline uint32 GetGeneration() const
+		{
+			return mGeneration;
+		}
+
+		inline void ResetHighWaterMark()
+		{
+			mHighWaterMark = GetBytesUsed();
+		}
+
+	private:
+		__declspec(noinline) void* AllocLarge(SIZE_T Size, uint32 Alignment)
+		{
+			_byte* pRet = (_byte*)Memory::AlignedAlloc(Size, Math::Max(Alignment, mBlockAlignment));
+
+			mLargeAllocs.Add(pRet);
+			mLargeBytes += Size;
+
+			UpdateHighWaterMark();
+
+			return pRet;
+		}
+
+		__forceinline void UpdateHighWaterMark()
+		{
+			mHighWaterMark = Math::Max(mHighWaterMark, GetBytesUsed());
+		}
+
+		static __forceinline bool IsPowerOfTwo(uint32 Value)
+		{
+			return Value != 0 && (Value & (Value - 1)) == 0;
+		}
+	};
+
+	/**
+	* Allocation policy drawing from a MemoryPool arena.
+	*
+	* Containers have their allocators default constructed, so the arena is picked up from the innermost ArenaScope
+	* active on the constructing thread and kept for the lifetime of the container. Memory is never freed individually:
+	* growing copies the elements to a new region (or extends the current one in place when it's the last allocation of
+	* the arena) and everything is released when the arena is rewound or freed. Element destructors still run as usual.
+	*
+	* The storage of a container therefore lives where it last grew, not where the container was created: a container
+	* must not grow after a Mark taken since its creation unless that mark has been rewound already, or rewinding to it
+	* would release storage still in use. Debug builds assert on such growth.
+	*/
+	class ArenaAllocator
+	{
+	public:
+
+		enum { NeedsElementType = true };
+		enum { RequireRangeCheck = true };
+
+		/** @return the arena new containers allocate from on this thread, or nullptr outside of any ArenaScope. */
+		static __forceinline MemoryPool*& GetCurrentArena()
+		{
+			static thread_local MemoryPool* CurrentArena = nullptr;
+			return CurrentArena;
+		}
+
+		template<typename ElementType>
+		class ForElementType
+		{
+		private:
+			/** At least 16 bytes, like the other allocation policies. */
+			enum { Alignment = ALIGNOF(ElementType) > 16 ? ALIGNOF(ElementType) : 16 };
+
+			/** A pointer to the container's elements. */
+			ElementType* Data;
+
+			/** Number of bytes reserved for Data in the arena. */
+			SIZE_T AllocatedBytes;
+
+			/** The arena Data is allocated from. */
+			MemoryPool* Arena;
+
+			/** The arena generation the container was created in, it may only grow while the arena is still in it. */
+			uint32 Generation;
+
+		public:
+			/** Default constructor. */
+			ForElementType()
+				: Data(nullptr)
+				, AllocatedBytes(0)
+				, Arena(GetCurrentArena())
+				, Generation(Arena ? Arena->GetGeneration() : 0)
+			{}
+
+			ForElementType(const ForElementType&) = delete;
+			ForElementType& operator=(const ForElementType&) = delete;
+
+			/**
+			* Moves the state of another allocator into this one.
+			* Assumes that the allocator is currently empty, i.e. memory may be allocated but any existing elements have already been destructed (if necessary).
+			* @param Other - The allocator to move the state from.  This allocator should be left in a valid empty state.
+			*/
+			__forceinline void MoveToEmpty(ForElementType& Other)
 			{
-				// Cache the current block for future use
-				mUsedBlocks.Add(mpCurrentBlock);
+				Assert(this != &Other);
+
+				Data = Other.Data;
+				AllocatedBytes = Other.AllocatedBytes;
+				Arena = Other.Arena;
+				Generation = Other.Generation;
+
+				Other.Data = nullptr;
+				Other.AllocatedBytes = 0;
+			}
 
-				// Use previously allocated blocks if the requested size is within block size
-				if (mAvailableBlocks.Size() > 0 && uiSize < mBlockSize)
+			// ContainerAllocatorInterface
+			__forceinline ElementType* GetAllocation() const
+			{
+				return Data;
+			}
+			void ResizeAllocation(int32 PreviousNumElements, int32 NumElements, SIZE_T NumBytesPerElement)
+			{
+				const SIZE_T NewBytes = NumElements * NumBytesPerElement;
+				if (NewBytes <= AllocatedBytes)
 				{
-					mpCurrentBlock = mAvailableBlocks.Top();
-					mAvailableBlocks.Pop();
+					// Shrinking only gives memory back if this is the top of the arena, and must not move the top below a newer mark
+					if (Data && Arena->GetGeneration() == Generation && Arena->TryResize(Data, AllocatedBytes, NewBytes))
+					{
+						AllocatedBytes = NewBytes;
+					}
+					return;
 				}
-				else // Else allocate new block in requested size
+
+				Assertf(Arena != nullptr, EDX_TEXT("Arena allocated container created outside of an ArenaScope"));
+				Assertf(Arena->GetGeneration() == Generation, EDX_TEXT("Arena allocated container grown after a newer Mark, rewinding to it would release the container's storage"));
+
+				if (Data && Arena->TryResize(Data, AllocatedBytes, NewBytes))
+				{
+					AllocatedBytes = NewBytes;
+					return;
+				}
+
+				ElementType* NewData = (ElementType*)Arena->Alloc(NewBytes, uint32(Alignment));
+				if (Data)
 				{
-					mpCurrentBlock = Memory::AlignedAlloc<_byte>(Math::Max(uiSize, mBlockSize));
+					Memory::Memcpy(NewData, Data, Math::Min(NumElements, PreviousNumElements) * NumBytesPerElement);
 				}
-				// Clear the current block offset
-				mCurrOffset = 0;
+
+				Data = NewData;
+				AllocatedBytes = NewBytes;
+			}
+			__forceinline int32 CalculateSlackReserve(int32 NumElements, int32 NumBytesPerElement) const
+			{
+				return DefaultCalculateSlackReserve(NumElements, NumBytesPerElement, false);
+			}
+			__forceinline int32 CalculateSlackShrink(int32 NumElements, int32 NumAllocatedElements, int32 NumBytesPerElement) const
+			{
+				return DefaultCalculateSlackShrink(NumElements, NumAllocatedElements, NumBytesPerElement, false);
+			}
+			__forceinline int32 CalculateSlackGrow(int32 NumElements, int32 NumAllocatedElements, int32 NumBytesPerElement) const
+			{
+				return DefaultCalculateSlackGrow(NumElements, NumAllocatedElements, NumBytesPerElement, false);
 			}
 
-			T* pRet = (T*)(mpCurrentBlock + mCurrOffset);
-			mCurrOffset += uiSize;
+			SIZE_T GetAllocatedSize(int32 NumAllocatedElements, SIZE_T NumBytesPerElement) const
+			{
+				return NumAllocatedElements * NumBytesPerElement;
+			}
 
-			return pRet;
+			bool HasAllocation()
+			{
+				return !!Data;
+			}
+		};
+
+		typedef void ForAnyElementType;
+	};
+
+	template <>
+	struct AllocatorTraits<ArenaAllocator> : AllocatorTraitsBase<ArenaAllocator>
+	{
+		enum { SupportsMove = true };
+	};
+
+	/** Sparse array allocator drawing both the elements and the allocation flags beyond the first 128 from an arena. */
+	typedef SparseArrayAllocator<ArenaAllocator, InlineAllocator<4, ArenaAllocator>> ArenaSparseArrayAllocator;
+
+	/** Set allocator drawing elements and hash buckets from an arena, usable with Set, Map and MultiMap. */
+	typedef SetAllocator<ArenaSparseArrayAllocator, InlineAllocator<1, ArenaAllocator>> ArenaSetAllocator;
+
+	/**
+	* Makes an arena the target of containers using ArenaAllocator constructed on this thread, for the lifetime of
+	* the scope. Scopes nest, the previous arena is restored on exit.
+	*/
+	class ArenaScope
+	{
+	public:
+		explicit ArenaScope(MemoryPool& InArena)
+			: PrevArena(ArenaAllocator::GetCurrentArena())
+		{
+			ArenaAllocator::GetCurrentArena() = &InArena;
 		}
 
-		inline void FreeAll()
+		~ArenaScope()
 		{
-			mCurrOffset = 0;
-			while (mUsedBlocks.Size())
-			{
-				mAvailableBlocks.Add(mUsedBlocks.Top());
-				mUsedBlocks.Pop();
-			}
+			ArenaAllocator::GetCurrentArena() = PrevArena;
 		}
+
+		ArenaScope(const ArenaScope&) = delete;
+		ArenaScope& operator=(const ArenaScope&) = delete;
+
+	private:
+		MemoryPool* PrevArena;
 	};
 }
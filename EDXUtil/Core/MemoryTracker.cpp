@@ -0,0 +1,396 @@
+
+#include "MemoryTracker.h"
+#include "Memory.h"
+#include "../Windows/Atomics.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace EDX
+{
+	/** A live allocation. */
+	struct LiveAllocation
+	{
+		void* Key;
+		SIZE_T Size;
+		void* CallSite;
+		MemoryTag Tag;
+	};
+
+	/** Statistics of one call site. */
+	struct CallSiteStats
+	{
+		void* Key;
+		MemoryTag Tag;
+		int64 LiveBytes;
+		int64 PeakBytes;
+		int64 TotalAllocs;
+	};
+
+	/**
+	* Open addressing hash table keyed by pointer, allocated from the system heap. Entries are zero initialized, the
+	* Key member being nullptr for empty slots and 1 for removed ones.
+	*/
+	template<typename EntryType>
+	class TrackerTable
+	{
+	public:
+		EntryType* Find(void* Key) const
+		{
+			if (Capacity == 0)
+			{
+				return nullptr;
+			}
+
+			for (SIZE_T Index = Hash(Key) & (Capacity - 1); Entries[Index].Key != nullptr; Index = (Index + 1) & (Capacity - 1))
+			{
+				if (Entries[Index].Key == Key)
+				{
+					return &Entries[Index];
+				}
+			}
+
+			return nullptr;
+		}
+
+		/** @return the entry of Key, added zero initialized if missing, or nullptr if out of memory. */
+		EntryType* FindOrAdd(void* Key)
+		{
+			if (EntryType* Found = Find(Key))
+			{
+				return Found;
+			}
+
+			if ((NumUsed + 1) * 2 > Capacity && !Grow())
+			{
+				return nullptr;
+			}
+
+			SIZE_T Index = Hash(Key) & (Capacity - 1);
+			while (Entries[Index].Key != nullptr && Entries[Index].Key != Tombstone())
+			{
+				Index = (Index + 1) & (Capacity - 1);
+			}
+
+			if (Entries[Index].Key == nullptr)
+			{
+				NumUsed++;
+			}
+			NumLive++;
+
+			Memory::Memzero(&Entries[Index], sizeof(EntryType));
+			Entries[Index].Key = Key;
+
+			return &Entries[Index];
+		}
+
+		void Remove(EntryType* Entry)
+		{
+			Entry->Key = Tombstone();
+			NumLive--;
+		}
+
+		template<typename FuncType>
+		void ForEach(FuncType Func) const
+		{
+			for (SIZE_T i = 0; i < Capacity; i++)
+			{
+				if (Entries[i].Key != nullptr && Entries[i].Key != Tombstone())
+				{
+					Func(Entries[i]);
+				}
+			}
+		}
+
+		SIZE_T Num() const
+		{
+			return NumLive;
+		}
+
+	private:
+		static __forceinline void* Tombstone()
+		{
+			return (void*)1;
+		}
+
+		static __forceinline SIZE_T Hash(void* Key)
+		{
+			return SIZE_T((uint64(UPTRINT(Key)) >> 4) * 0x9E3779B97F4A7C15ull >> 16);
+		}
+
+		/** Doubles the capacity if the live entries need it, otherwise just drops the tombstones. */
+		bool Grow()
+		{
+			const SIZE_T NewCapacity = (NumLive + 1) * 4 > Capacity ? Math::Max(Capacity * 2, SIZE_T(1024)) : Capacity;
+
+			EntryType* NewEntries = (EntryType*)Memory::SystemMalloc(NewCapacity * sizeof(EntryType));
+			if (NewEntries == nullptr)
+			{
+				return false;
+			}
+			Memory::Memzero(NewEntries, NewCapacity * sizeof(EntryType));
+
+			for (SIZE_T i = 0; i < Capacity; i++)
+			{
+				if (Entries[i].Key != nullptr && Entries[i].Key != Tombstone())
+				{
+					SIZE_T Index = Hash(Entries[i].Key) & (NewCapacity - 1);
+					while (NewEntries[Index].Key != nullptr)
+					{
+						Index = (Index + 1) & (NewCapacity - 1);
+					}
+
+					NewEntries[Index] = Entries[i];
+				}
+			}
+
+			Memory::SystemFree(Entries);
+			Entries = NewEntries;
+			Capacity = NewCapacity;
+			NumUsed = NumLive;
+
+			return true;
+		}
+
+	public:
+		// Zero initialized as globals, usable before static constructors run
+		EntryType* Entries;
+		SIZE_T Capacity;
+		SIZE_T NumUsed;
+		SIZE_T NumLive;
+	};
+
+	static TrackerTable<LiveAllocation> GLiveAllocations;
+	static TrackerTable<CallSiteStats> GCallSites;
+	static MemoryTagStats GTagStats[int32(MemoryTag::Count)];
+
+	static volatile int32 GTrackerLock = 0;
+	static bool GTrackCallSites = false;
+
+	static thread_local MemoryTag GCurrentTag = MemoryTag::Untagged;
+
+	/** Spin lock guarding the tracker state. A CriticalSection would need constructing before the first allocation. */
+	class ScopedTrackerLock
+	{
+	public:
+		ScopedTrackerLock()
+		{
+			while (WindowsAtomics::InterlockedCompareExchange(&GTrackerLock, 1, 0) != 0)
+			{
+				::SwitchToThread();
+			}
+		}
+
+		~ScopedTrackerLock()
+		{
+			WindowsAtomics::InterlockedExchange(&GTrackerLock, 0);
+		}
+	};
+
+	static __forceinline int32 GetHistogramBucket(SIZE_T Size)
+	{
+		const uint64 Size64 = uint64(Size);
+		if (Size64 >> 32)
+		{
+			return Math::Min(int32(Math::FloorLog2(uint(Size64 >> 32))) + 32, int32(MemoryTagStats::NumHistogramBuckets) - 1);
+		}
+
+		return Size64 ? int32(Math::FloorLog2(uint(Size64))) : 0;
+	}
+
+	void MemoryTracker::OnAlloc(void* Ptr, SIZE_T Size, void* CallSite)
+	{
+		if (Ptr == nullptr)
+		{
+			return;
+		}
+
+		const MemoryTag Tag = GCurrentTag;
+
+		ScopedTrackerLock Lock;
+
+		MemoryTagStats& Stats = GTagStats[int32(Tag)];
+		Stats.LiveBytes += Size;
+		Stats.PeakBytes = Math::Max(Stats.PeakBytes, Stats.LiveBytes);
+		Stats.LiveAllocs++;
+		Stats.TotalAllocs++;
+		Stats.SizeHistogram[GetHistogramBucket(Size)]++;
+
+		if (!GTrackCallSites)
+		{
+			CallSite = nullptr;
+		}
+
+		if (LiveAllocation* Allocation = GLiveAllocations.FindOrAdd(Ptr))
+		{
+			Allocation->Size = Size;
+			Allocation->CallSite = CallSite;
+			Allocation->Tag = Tag;
+		}
+
+		if (CallSite)
+		{
+			if (CallSiteStats* Site = GCallSites.FindOrAdd(CallSite))
+			{
+				Site->Tag = Tag;
+				Site->LiveBytes += Size;
+				Site->PeakBytes = Math::Max(Site->PeakBytes, Site->LiveBytes);
+				Site->TotalAllocs++;
+			}
+		}
+	}
+
+	void MemoryTracker::OnFree(void* Ptr)
+	{
+		if (Ptr == nullptr)
+		{
+			return;
+		}
+
+		ScopedTrackerLock Lock;
+
+		LiveAllocation* Allocation = GLiveAllocations.Find(Ptr);
+		if (Allocation == nullptr)
+		{
+			return;
+		}
+
+		MemoryTagStats& Stats = GTagStats[int32(Allocation->Tag)];
+		Stats.LiveBytes -= Allocation->Size;
+		Stats.LiveAllocs--;
+		Stats.TotalFrees++;
+
+		if (Allocation->CallSite)
+		{
+			if (CallSiteStats* Site = GCallSites.Find(Allocation->CallSite))
+			{
+				Site->LiveBytes -= Allocation->Size;
+			}
+		}
+
+		GLiveAllocations.Remove(Allocation);
+	}
+
+	MemoryTag MemoryTracker::GetCurrentTag()
+	{
+		return GCurrentTag;
+	}
+
+	void MemoryTracker::SetCurrentTag(MemoryTag Tag)
+	{
+		GCurrentTag = Tag;
+	}
+
+	void MemoryTracker::SetTrackCallSites(bool bEnable)
+	{
+		GTrackCallSites = bEnable;
+	}
+
+	void MemoryTracker::GetTagStats(MemoryTag Tag, MemoryTagStats& OutStats)
+	{
+		ScopedTrackerLock Lock;
+		OutStats = GTagStats[int32(Tag)];
+	}
+
+	void MemoryTracker::ResetPeaks()
+	{
+		ScopedTrackerLock Lock;
+
+		for (auto& Stats : GTagStats)
+		{
+			Stats.PeakBytes = Stats.LiveBytes;
+		}
+
+		GCallSites.ForEach([](CallSiteStats& Site)
+		{
+			Site.PeakBytes = Site.LiveBytes;
+		});
+	}
+
+	const char* MemoryTracker::GetTagName(MemoryTag Tag)
+	{
+		static const char* TagNames[] =
+		{
+			"Untagged",
+			"Containers",
+			"Mesh",
+			"Texture",
+			"Threading",
+		};
+		static_assert(sizeof(TagNames) / sizeof(TagNames[0]) == int32(MemoryTag::Count), "Missing memory tag names");
+
+		return TagNames[int32(Tag)];
+	}
+
+	static int CompareCallSites(const void* A, const void* B)
+	{
+		const int64 AllocsA = ((const CallSiteStats*)A)->TotalAllocs;
+		const int64 AllocsB = ((const CallSiteStats*)B)->TotalAllocs;
+
+		return AllocsA > AllocsB ? -1 : (AllocsA < AllocsB ? 1 : 0);
+	}
+
+	bool MemoryTracker::WriteReport(const char* strFilename, int32 MaxCallSites)
+	{
+		// Snapshot everything first, writing the file allocates
+		MemoryTagStats TagStats[int32(MemoryTag::Count)];
+		CallSiteStats* Sites = nullptr;
+		SIZE_T NumSites = 0;
+		{
+			ScopedTrackerLock Lock;
+
+			Memory::Memcpy(TagStats, GTagStats, sizeof(TagStats));
+
+			Sites = (CallSiteStats*)Memory::SystemMalloc(Math::Max(GCallSites.Num(), SIZE_T(1)) * sizeof(CallSiteStats));
+			if (Sites == nullptr)
+			{
+				return false;
+			}
+
+			GCallSites.ForEach([&](const CallSiteStats& Site)
+			{
+				Sites[NumSites++] = Site;
+			});
+		}
+
+		qsort(Sites, NumSites, sizeof(CallSiteStats), CompareCallSites);
+		NumSites = Math::Min(NumSites, SIZE_T(Math::Max(MaxCallSites, 0)));
+
+		FILE* pFile = nullptr;
+		fopen_s(&pFile, strFilename, "wt");
+		if (pFile == nullptr)
+		{
+			Memory::SystemFree(Sites);
+			return false;
+		}
+
+		fprintf(pFile, "{\n\t\"tags\": [\n");
+		for (int32 i = 0; i < int32(MemoryTag::Count); i++)
+		{
+			const MemoryTagStats& Stats = TagStats[i];
+			fprintf(pFile, "\t\t{ \"name\": \"%s\", \"liveBytes\": %lld, \"peakBytes\": %lld, \"liveAllocs\": %lld, \"totalAllocs\": %lld, \"totalFrees\": %lld, \"sizeHistogram\": [",
+				GetTagName(MemoryTag(i)), Stats.LiveBytes, Stats.PeakBytes, Stats.LiveAllocs, Stats.TotalAllocs, Stats.TotalFrees);
+
+			for (int32 Bucket = 0; Bucket < MemoryTagStats::NumHistogramBuckets; Bucket++)
+			{
+				fprintf(pFile, Bucket ? ", %lld" : "%lld", Stats.SizeHistogram[Bucket]);
+			}
+
+			fprintf(pFile, "] }%s\n", i + 1 < int32(MemoryTag::Count) ? "," : "");
+		}
+
+		fprintf(pFile, "\t],\n\t\"callSites\": [\n");
+		for (SIZE_T i = 0; i < NumSites; i++)
+		{
+			const CallSiteStats& Site = Sites[i];
+			fprintf(pFile, "\t\t{ \"address\": \"0x%llx\", \"tag\": \"%s\", \"liveBytes\": %lld, \"peakBytes\": %lld, \"totalAllocs\": %lld }%s\n",
+				(unsigned long long)UPTRINT(Site.Key), GetTagName(Site.Tag), Site.LiveBytes, Site.PeakBytes, Site.TotalAllocs, i + 1 < NumSites ? "," : "");
+		}
+		fprintf(pFile, "\t]\n}\n");
+
+		fclose(pFile);
+		Memory::SystemFree(Sites);
+
+		return true;
+	}
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "Types.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define EDX_RETURN_ADDRESS() _ReturnAddress()
+#else
+#define EDX_RETURN_ADDRESS() __builtin_return_address(0)
+#endif
+
+/**
+* Records every allocation going through Memory::AlignedAlloc, AlignedRealloc and Free in MemoryTracker.
+* Costs a global lock per allocation, meant for profiling builds.
+*/
+#ifndef EDX_TRACK_ALLOCATIONS
+#define EDX_TRACK_ALLOCATIONS 0
+#endif
+
+#if EDX_TRACK_ALLOCATIONS
+#define EDX_MEMORY_TAG_SCOPE(Tag) MemoryTagScope MemoryTagScope_##Tag(MemoryTag::Tag)
+#define EDX_MEMORY_TAG_SCOPE_IF_UNTAGGED(Tag) MemoryTagScope MemoryTagScope_##Tag(MemoryTag::Tag, false)
+#else
+#define EDX_MEMORY_TAG_SCOPE(Tag)
+#define EDX_MEMORY_TAG_SCOPE_IF_UNTAGGED(Tag)
+#endif
+
+namespace EDX
+{
+	/** Subsystem an allocation is accounted to. */
+	enum class MemoryTag : uint8
+	{
+		Untagged,
+		Containers,
+		Mesh,
+		Texture,
+		Threading,
+
+		Count
+	};
+
+	/** Allocation statistics of one tag. */
+	struct MemoryTagStats
+	{
+		enum { NumHistogramBuckets = 32 };
+
+		int64 LiveBytes;
+		int64 PeakBytes;
+		int64 LiveAllocs;
+		int64 TotalAllocs;
+		int64 TotalFrees;
+
+		/** Number of allocations by size, bucket i counts sizes in [2^i, 2^(i+1)). */
+		int64 SizeHistogram[NumHistogramBuckets];
+	};
+
+	/**
+	* Accounts live and peak bytes, allocation counts and size histograms per MemoryTag, and optionally per call site,
+	* for the allocations made through Memory. Memory only reports to it when EDX_TRACK_ALLOCATIONS is set.
+	*
+	* Bookkeeping lives in tables allocated from the system heap, so the tracker never recurses into Memory.
+	*/
+	class MemoryTracker
+	{
+	public:
+		/** Records a new allocation, accounted to the calling thread's current tag. */
+		static void OnAlloc(void* Ptr, SIZE_T Size, void* CallSite);
+
+		/** Records the release of an allocation. Pointers the tracker hasn't seen are ignored. */
+		static void OnFree(void* Ptr);
+
+		/** @return the tag new allocations of the calling thread are accounted to. */
+		static MemoryTag GetCurrentTag();
+		static void SetCurrentTag(MemoryTag Tag);
+
+		/**
+		* Enables accounting per call site. The call site is the return address of the function calling into Memory,
+		* which is usually a container or allocation policy, one level above the code responsible for the allocation.
+		*/
+		static void SetTrackCallSites(bool bEnable);
+
+		static void GetTagStats(MemoryTag Tag, MemoryTagStats& OutStats);
+
+		/** Resets the peak bytes of every tag and call site to their live bytes. */
+		static void ResetPeaks();
+
+		/**
+		* Writes all the statistics to a JSON file. Call sites are sorted by number of allocations, the churn being
+		* what usually hurts latency.
+		*
+		* @param MaxCallSites Maximum number of call sites written
+		*/
+		static bool WriteReport(const char* strFilename, int32 MaxCallSites = 100);
+
+		static const char* GetTagName(MemoryTag Tag);
+	};
+
+	/** Accounts the allocations of the calling thread to a tag for the lifetime of the scope. */
+	class MemoryTagScope
+	{
+	public:
+		/**
+		* @param Tag The tag to account allocations to
+		* @param bOverride If false, the tag is only applied if no enclosing scope has set one
+		*/
+		explicit MemoryTagScope(MemoryTag Tag, bool bOverride = true)
+			: PrevTag(MemoryTracker::GetCurrentTag())
+		{
+			if (bOverride || PrevTag == MemoryTag::Untagged)
+			{
+				MemoryTracker::SetCurrentTag(Tag);
+			}
+		}
+
+		~MemoryTagScope()
+		{
+			MemoryTracker::SetCurrentTag(PrevTag);
+		}
+
+		MemoryTagScope(const MemoryTagScope&) = delete;
+		MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+
+	private:
+		MemoryTag PrevTag;
+	};
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "Types.h"
+#include "Memory.h"
+#include "Template.h"
+#include "../Containers/Array.h"
+#include "../Windows/Threading.h"
+
+#include <new>
+
+namespace EDX
+{
+	namespace ObjectPool_Private
+	{
+		/** Lock used by pools that are only accessed from one thread. */
+		struct NoLock
+		{
+			__forceinline void Lock() {}
+			__forceinline void Unlock() {}
+		};
+
+		template<typename LockType>
+		class ScopedPoolLock
+		{
+		public:
+			explicit ScopedPoolLock(LockType& InLock)
+				: PoolLock(InLock)
+			{
+				PoolLock.Lock();
+			}
+
+			~ScopedPoolLock()
+			{
+				PoolLock.Unlock();
+			}
+
+		private:
+			LockType& PoolLock;
+		};
+	}
+
+	/**
+	* Fixed size object pool.
+	*
+	* Objects are carved out of chunks holding a fixed number of slots each. Free slots are chained through an
+	* embedded free list, so allocating and freeing an object is a pointer swap and chunks are only allocated when
+	* the free list runs empty. Chunks are only returned to the heap by Empty or the destructor.
+	*
+	* @param ObjectType The type of the pooled objects.
+	* @param bThreadSafe If true, every operation is guarded by a critical section.
+	*/
+	template<typename ObjectType, bool bThreadSafe = false>
+	class ObjectPool
+	{
+	private:
+		/** Storage of one object, doubles as free list link while the slot is unused. */
+		union Slot
+		{
+			TypeCompatibleBytes<ObjectType> Object;
+			Slot* NextFree;
+		};
+
+		typedef typename ChooseClass<bThreadSafe, CriticalSection, ObjectPool_Private::NoLock>::Result LockType;
+		typedef ObjectPool_Private::ScopedPoolLock<LockType> ScopedLock;
+
+	public:
+		/**
+		* Constructor.
+		*
+		* @param InNumPerChunk Number of objects per chunk, 0 picks a chunk size of about 16KB.
+		*/
+		explicit ObjectPool(int32 InNumPerChunk = 0)
+			: FreeList(nullptr)
+			, NumPerChunk(InNumPerChunk > 0 ? InNumPerChunk : Math::Max(int32(16384 / sizeof(Slot)), 16))
+			, NumLive(0)
+			, PeakLive(0)
+			, NumAllocs(0)
+		{
+		}
+
+		~ObjectPool()
+		{
+			Empty();
+		}
+
+		ObjectPool(const ObjectPool&) = delete;
+		ObjectPool& operator=(const ObjectPool&) = delete;
+
+		/**
+		* Allocates storage for one object without constructing it.
+		*
+		* @return uninitialized storage for an ObjectType
+		*/
+		void* Alloc()
+		{
+			ScopedLock Lock(PoolLock);
+
+			if (FreeList == nullptr)
+			{
+				AllocateChunk();
+			}
+
+			Slot* Result = FreeList;
+			FreeList = Result->NextFree;
+
+			NumAllocs++;
+			if (++NumLive > PeakLive)
+			{
+				PeakLive = NumLive;
+			}
+
+			return Result;
+		}
+
+		/** Returns storage obtained from Alloc to the pool. The object must have been destructed already. */
+		void Free(void* Ptr)
+		{
+			if (Ptr == nullptr)
+			{
+				return;
+			}
+
+			ScopedLock Lock(PoolLock);
+			Assert(NumLive > 0);
+
+			Slot* FreedSlot = (Slot*)Ptr;
+			FreedSlot->NextFree = FreeList;
+			FreeList = FreedSlot;
+
+			NumLive--;
+		}
+
+		/** Allocates and constructs an object in place. */
+		template<typename... ArgTypes>
+		ObjectType* Construct(ArgTypes&&... Args)
+		{
+			return new(Alloc()) ObjectType(Forward<ArgTypes>(Args)...);
+		}
+
+		/** Destructs an object created by Construct and returns its storage to the pool. */
+		void Destroy(ObjectType* Object)
+		{
+			if (Object == nullptr)
+			{
+				return;
+			}
+
+			DestructItems(Object, 1);
+			Free(Object);
+		}
+
+		/**
+		* Makes every slot available again without calling any destructor. Only valid if ObjectType is trivially
+		* destructible or every live object has been destroyed already. Keeps the chunks for reuse.
+		*/
+		void Reset()
+		{
+			ScopedLock Lock(PoolLock);
+
+			FreeList = nullptr;
+			for (int32 i = Chunks.Size() - 1; i >= 0; i--)
+			{
+				LinkChunk(Chunks[i]);
+			}
+
+			NumLive = 0;
+		}
+
+		/** Like Reset, but also returns the chunks to the heap. */
+		void Empty()
+		{
+			ScopedLock Lock(PoolLock);
+
+			for (auto* Chunk : Chunks)
+			{
+				Memory::Free(Chunk);
+			}
+			Chunks.Clear();
+
+			FreeList = nullptr;
+			NumLive = 0;
+		}
+
+		/** @return the number of objects currently allocated. */
+		int32 GetNumLive() const { return NumLive; }
+
+		/** @return the highest number of objects allocated at the same time. */
+		int32 GetPeakLive() const { return PeakLive; }
+
+		/** @return the total number of allocations served since construction. */
+		int64 GetNumAllocs() const { return NumAllocs; }
+
+		/** @return the number of chunks allocated. */
+		int32 GetNumChunks() const { return Chunks.Size(); }
+
+		/** @return the number of bytes allocated for object storage. */
+		SIZE_T GetAllocatedSize() const { return SIZE_T(Chunks.Size()) * NumPerChunk * sizeof(Slot); }
+
+	private:
+		void AllocateChunk()
+		{
+			Slot* Chunk = (Slot*)Memory::AlignedAlloc(NumPerChunk * sizeof(Slot), uint32(Math::Max(ALIGNOF(Slot), 16)));
+			Chunks.Add(Chunk);
+
+			LinkChunk(Chunk);
+		}
+
+		/** Pushes all slots of a chunk on the free list, in address order. */
+		void LinkChunk(Slot* Chunk)
+		{
+			for (int32 i = NumPerChunk - 1; i >= 0; i--)
+			{
+				Chunk[i].NextFree = FreeList;
+				FreeList = &Chunk[i];
+			}
+		}
+
+		Slot* FreeList;
+		Array<Slot*> Chunks;
+		int32 NumPerChunk;
+
+		int32 NumLive;
+		int32 PeakLive;
+		int64 NumAllocs;
+
+		LockType PoolLock;
+	};
+}
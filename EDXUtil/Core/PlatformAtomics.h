@@ -0,0 +1,317 @@
+#pragma once
+
+#include "Types.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(_M_X64) || (defined(__x86_64__) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16))
+#define PLATFORM_HAS_128BIT_CAS 1
+#else
+#define PLATFORM_HAS_128BIT_CAS 0
+#endif
+
+namespace EDX
+{
+	/**
+	* Memory ordering constraints for atomic operations, same semantics as the C++11 ones.
+	*/
+	enum class EMemoryOrder
+	{
+		/** Atomicity only, no ordering with surrounding memory operations. */
+		Relaxed,
+
+		/** No later reads or writes can be reordered before this load. */
+		Acquire,
+
+		/** No earlier reads or writes can be reordered after this store. */
+		Release,
+
+		/** Acquire and Release, for read-modify-write operations. */
+		AcquireRelease,
+
+		/** Total order with all other sequentially consistent operations. */
+		SequentiallyConsistent,
+	};
+
+	/**
+	* 128-bit value for double-width compare and swap.
+	*/
+	struct __declspec(align(16)) Int128
+	{
+		int64 Low;
+		int64 High;
+	};
+
+	namespace Atomics_Private
+	{
+		template<typename To, typename From>
+		__forceinline To BitCast(const From& Value)
+		{
+			static_assert(sizeof(To) == sizeof(From), "BitCast requires types of the same size");
+
+			union
+			{
+				From Src;
+				To Dst;
+			} Convert;
+
+			Convert.Src = Value;
+			return Convert.Dst;
+		}
+
+#if defined(_MSC_VER)
+		/**
+		* Size dispatched wrappers around the MSVC interlocked intrinsics. On x86 and x64 every interlocked instruction is a
+		* full barrier, so the requested ordering is always satisfied.
+		*/
+		template<SIZE_T Size>
+		struct InterlockedOps;
+
+		template<>
+		struct InterlockedOps<4>
+		{
+			typedef long Type;
+
+			static __forceinline Type Exchange(volatile Type* Dest, Type Value) { return _InterlockedExchange(Dest, Value); }
+			static __forceinline Type FetchAdd(volatile Type* Dest, Type Value) { return _InterlockedExchangeAdd(Dest, Value); }
+			static __forceinline Type FetchOr(volatile Type* Dest, Type Value) { return _InterlockedOr(Dest, Value); }
+			static __forceinline Type FetchAnd(volatile Type* Dest, Type Value) { return _InterlockedAnd(Dest, Value); }
+			static __forceinline Type CompareExchange(volatile Type* Dest, Type Desired, Type Comparand) { return _InterlockedCompareExchange(Dest, Desired, Comparand); }
+			static __forceinline Type Load(const volatile Type* Src) { return *Src; }
+			static __forceinline void Store(volatile Type* Dest, Type Value) { *Dest = Value; }
+		};
+
+		template<>
+		struct InterlockedOps<8>
+		{
+			typedef __int64 Type;
+
+			static __forceinline Type CompareExchange(volatile Type* Dest, Type Desired, Type Comparand) { return _InterlockedCompareExchange64(Dest, Desired, Comparand); }
+
+#if defined(_M_X64)
+			static __forceinline Type Exchange(volatile Type* Dest, Type Value) { return _InterlockedExchange64(Dest, Value); }
+			static __forceinline Type FetchAdd(volatile Type* Dest, Type Value) { return _InterlockedExchangeAdd64(Dest, Value); }
+			static __forceinline Type FetchOr(volatile Type* Dest, Type Value) { return _InterlockedOr64(Dest, Value); }
+			static __forceinline Type FetchAnd(volatile Type* Dest, Type Value) { return _InterlockedAnd64(Dest, Value); }
+			static __forceinline Type Load(const volatile Type* Src) { return *Src; }
+			static __forceinline void Store(volatile Type* Dest, Type Value) { *Dest = Value; }
+#else
+			// No 64-bit interlocked instructions other than cmpxchg8b on x86, and plain 64-bit moves aren't atomic
+			static __forceinline Type Exchange(volatile Type* Dest, Type Value)
+			{
+				Type Old;
+				do { Old = *Dest; } while (CompareExchange(Dest, Value, Old) != Old);
+				return Old;
+			}
+			static __forceinline Type FetchAdd(volatile Type* Dest, Type Value)
+			{
+				Type Old;
+				do { Old = *Dest; } while (CompareExchange(Dest, Old + Value, Old) != Old);
+				return Old;
+			}
+			static __forceinline Type FetchOr(volatile Type* Dest, Type Value)
+			{
+				Type Old;
+				do { Old = *Dest; } while (CompareExchange(Dest, Old | Value, Old) != Old);
+				return Old;
+			}
+			static __forceinline Type FetchAnd(volatile Type* Dest, Type Value)
+			{
+				Type Old;
+				do { Old = *Dest; } while (CompareExchange(Dest, Old & Value, Old) != Old);
+				return Old;
+			}
+			static __forceinline Type Load(const volatile Type* Src) { return CompareExchange((volatile Type*)Src, 0, 0); }
+			static __forceinline void Store(volatile Type* Dest, Type Value) { Exchange(Dest, Value); }
+#endif
+		};
+#else
+		__forceinline constexpr int ToBuiltinOrder(EMemoryOrder Order)
+		{
+			return Order == EMemoryOrder::Relaxed ? __ATOMIC_RELAXED
+				: Order == EMemoryOrder::Acquire ? __ATOMIC_ACQUIRE
+				: Order == EMemoryOrder::Release ? __ATOMIC_RELEASE
+				: Order == EMemoryOrder::AcquireRelease ? __ATOMIC_ACQ_REL
+				: __ATOMIC_SEQ_CST;
+		}
+
+		/** Failure ordering of a compare exchange can't be a release. */
+		__forceinline constexpr int ToBuiltinFailureOrder(EMemoryOrder Order)
+		{
+			return Order == EMemoryOrder::Release ? __ATOMIC_RELAXED
+				: Order == EMemoryOrder::AcquireRelease ? __ATOMIC_ACQUIRE
+				: ToBuiltinOrder(Order);
+		}
+#endif
+	}
+
+	/**
+	* Portable atomic operations with explicit memory ordering.
+	*
+	* Maps to the interlocked intrinsics with MSVC and to the __atomic builtins with GCC and Clang. Operates on naturally
+	* aligned 32-bit and 64-bit integers and pointers. All operations default to sequential consistency; relax the order
+	* only where the reasoning is written down next to the call.
+	*/
+	class PlatformAtomics
+	{
+	public:
+		template<typename T>
+		static __forceinline T Load(const volatile T* Src, EMemoryOrder Order = EMemoryOrder::SequentiallyConsistent)
+		{
+#if defined(_MSC_VER)
+			typedef Atomics_Private::InterlockedOps<sizeof(T)> Ops;
+			// Aligned loads are atomic and already have acquire semantics on x86, only the compiler needs fencing
+			const T Result = Atomics_Private::BitCast<T>(Ops::Load((const volatile typename Ops::Type*)Src));
+			_ReadWriteBarrier();
+			return Result;
+#else
+			return __atomic_load_n(Src, Atomics_Private::ToBuiltinOrder(Order));
+#endif
+		}
+
+		template<typename T>
+		static __forceinline void Store(volatile T* Dest, T Value, EMemoryOrder Order = EMemoryOrder::SequentiallyConsistent)
+		{
+#if defined(_MSC_VER)
+			typedef Atomics_Private::InterlockedOps<sizeof(T)> Ops;
+			if (Order == EMemoryOrder::SequentiallyConsistent)
+			{
+				// A plain store may be reordered with a later load on x86, the locked exchange can't
+				Ops::Exchange((volatile typename Ops::Type*)Dest, Atomics_Private::BitCast<typename Ops::Type>(Value));
+			}
+			else
+			{
+				_ReadWriteBarrier();
+				Ops::Store((volatile typename Ops::Type*)Dest, Atomics_Private::BitCast<typename Ops::Type>(Value));
+			}
+#else
+			__atomic_store_n(Dest, Value, Atomics_Private::ToBuiltinOrder(Order));
+#endif
+		}
+
+		/** @return the previous value */
+		template<typename T>
+		static __forceinline T Exchange(volatile T* Dest, T Value, EMemoryOrder Order = EMemoryOrder::SequentiallyConsistent)
+		{
+#if defined(_MSC_VER)
+			typedef Atomics_Private::InterlockedOps<sizeof(T)> Ops;
+			return Atomics_Private::BitCast<T>(Ops::Exchange((volatile typename Ops::Type*)Dest, Atomics_Private::BitCast<typename Ops::Type>(Value)));
+#else
+			return __atomic_exchange_n(Dest, Value, Atomics_Private::ToBuiltinOrder(Order));
+#endif
+		}
+
+		/**
+		* Stores Desired in Dest if it holds Expected. Otherwise Expected is updated with the current value.
+		*
+		* @return true if the exchange took place
+		*/
+		template<typename T>
+		static __forceinline bool CompareExchange(volatile T* Dest, T& Expected, T Desired, EMemoryOrder Order = EMemoryOrder::SequentiallyConsistent)
+		{
+#if defined(_MSC_VER)
+			typedef Atomics_Private::InterlockedOps<sizeof(T)> Ops;
+			const typename Ops::Type Comparand = Atomics_Private::BitCast<typename Ops::Type>(Expected);
+			const typename Ops::Type Previous = Ops::CompareExchange((volatile typename Ops::Type*)Dest, Atomics_Private::BitCast<typename Ops::Type>(Desired), Comparand);
+			if (Previous == Comparand)
+			{
+				return true;
+			}
+
+			Expected = Atomics_Private::BitCast<T>(Previous);
+			return false;
+#else
+			return __atomic_compare_exchange_n(Dest, &Expected, Desired, false, Atomics_Private::ToBuiltinOrder(Order), Atomics_Private::ToBuiltinFailureOrder(Order));
+#endif
+		}
+
+		/** @return the previous value */
+		template<typename T>
+		static __forceinline T FetchAdd(volatile T* Dest, T Value, EMemoryOrder Order = EMemoryOrder::SequentiallyConsistent)
+		{
+#if defined(_MSC_VER)
+			typedef Atomics_Private::InterlockedOps<sizeof(T)> Ops;
+			return (T)Ops::FetchAdd((volatile typename Ops::Type*)Dest, (typename Ops::Type)Value);
+#else
+			return __atomic_fetch_add(Dest, Value, Atomics_Private::ToBuiltinOrder(Order));
+#endif
+		}
+
+		/** @return the previous value */
+		template<typename T>
+		static __forceinline T FetchSub(volatile T* Dest, T Value, EMemoryOrder Order = EMemoryOrder::SequentiallyConsistent)
+		{
+			return FetchAdd(Dest, T(0) - Value, Order);
+		}
+
+		/** @return the previous value */
+		template<typename T>
+		static __forceinline T FetchOr(volatile T* Dest, T Value, EMemoryOrder Order = EMemoryOrder::SequentiallyConsistent)
+		{
+#if defined(_MSC_VER)
+			typedef Atomics_Private::InterlockedOps<sizeof(T)> Ops;
+			return (T)Ops::FetchOr((volatile typename Ops::Type*)Dest, (typename Ops::Type)Value);
+#else
+			return __atomic_fetch_or(Dest, Value, Atomics_Private::ToBuiltinOrder(Order));
+#endif
+		}
+
+		/** @return the previous value */
+		template<typename T>
+		static __forceinline T FetchAnd(volatile T* Dest, T Value, EMemoryOrder Order = EMemoryOrder::SequentiallyConsistent)
+		{
+#if defined(_MSC_VER)
+			typedef Atomics_Private::InterlockedOps<sizeof(T)> Ops;
+			return (T)Ops::FetchAnd((volatile typename Ops::Type*)Dest, (typename Ops::Type)Value);
+#else
+			return __atomic_fetch_and(Dest, Value, Atomics_Private::ToBuiltinOrder(Order));
+#endif
+		}
+
+		/** Full memory fence. */
+		static __forceinline void ThreadFence(EMemoryOrder Order = EMemoryOrder::SequentiallyConsistent)
+		{
+#if defined(_MSC_VER)
+			if (Order == EMemoryOrder::SequentiallyConsistent)
+			{
+				_mm_mfence();
+			}
+			else
+			{
+				_ReadWriteBarrier();
+			}
+#else
+			__atomic_thread_fence(Atomics_Private::ToBuiltinOrder(Order));
+#endif
+		}
+
+#if PLATFORM_HAS_128BIT_CAS
+		/**
+		* Double-width compare and swap. Dest must be 16-byte aligned. Always sequentially consistent.
+		*
+		* Early AMD64 processors lack cmpxchg16b, see WindowsAtomics::CanUseCompareExchange128.
+		*
+		* @return true if the exchange took place, otherwise Expected is updated with the current value
+		*/
+		static __forceinline bool CompareExchange128(volatile Int128* Dest, Int128& Expected, const Int128& Desired)
+		{
+#if defined(_MSC_VER)
+			return _InterlockedCompareExchange128((volatile __int64*)Dest, Desired.High, Desired.Low, (__int64*)&Expected) == 1;
+#else
+			typedef unsigned __int128 NativeType;
+			const NativeType Comparand = Atomics_Private::BitCast<NativeType>(Expected);
+			const NativeType Previous = __sync_val_compare_and_swap((volatile NativeType*)Dest, Comparand, Atomics_Private::BitCast<NativeType>(Desired));
+			if (Previous == Comparand)
+			{
+				return true;
+			}
+
+			Expected = Atomics_Private::BitCast<Int128>(Previous);
+			return false;
+#endif
+		}
+#endif
+	};
+}
@@ -0,0 +1,362 @@
+
+#include "Reclamation.h"
+#include "Sorting.h"
+#include "../Containers/Algorithm.h"
+
+#include <new>
+
+namespace EDX
+{
+	/**
+	* Per-thread hazard pointer state. Records live in a global push-only list and are recycled across threads.
+	*/
+	struct __declspec(align(PLATFORM_CACHE_LINE_SIZE)) HazardRecord
+	{
+		void* volatile Hazards[HazardPointers::SlotsPerThread];
+		volatile int32 bActive;
+		HazardRecord* Next;
+		Array<RetiredPtr> RetireList;
+	};
+
+	static HazardRecord* volatile GHazardRecords = nullptr;
+	static volatile int32 GNumHazardRecords = 0;
+
+	/**
+	* Per-thread epoch state. Same lifetime rules as HazardRecord.
+	*/
+	struct __declspec(align(PLATFORM_CACHE_LINE_SIZE)) EpochRecord
+	{
+		// Epoch observed when entering the critical section, shifted left by one. The low bit is set while pinned.
+		volatile int64 State;
+		volatile int32 bActive;
+		int32 NestCount;
+		int32 RetiresSinceAdvance;
+		EpochRecord* Next;
+
+		Array<RetiredPtr> Limbo[3];
+		int64 LimboEpoch[3];
+	};
+
+	static EpochRecord* volatile GEpochRecords = nullptr;
+	static __declspec(align(PLATFORM_CACHE_LINE_SIZE)) volatile int64 GGlobalEpoch = 0;
+
+	/**
+	* Finds an inactive record in the list and claims it, or pushes a newly allocated one.
+	*/
+	template<typename RecordType>
+	static RecordType* AcquireRecord(RecordType* volatile& ListHead, bool& bOutNewRecord)
+	{
+		for (RecordType* Record = ListHead; Record; Record = Record->Next)
+		{
+			if (Record->bActive == 0 && WindowsAtomics::InterlockedCompareExchange(&Record->bActive, 1, 0) == 0)
+			{
+				bOutNewRecord = false;
+				return Record;
+			}
+		}
+
+		void* Mem = Memory::AlignedAlloc(sizeof(RecordType), PLATFORM_CACHE_LINE_SIZE);
+		Memory::Memzero(Mem, sizeof(RecordType));
+
+		RecordType* Record = new(Mem) RecordType;
+		Record->bActive = 1;
+
+		RecordType* OldHead;
+		do
+		{
+			OldHead = ListHead;
+			Record->Next = OldHead;
+		} while (WindowsAtomics::InterlockedCompareExchangePointer((void**)&ListHead, Record, OldHead) != OldHead);
+
+		bOutNewRecord = true;
+		return Record;
+	}
+
+	static void ScanHazardRecord(HazardRecord* Record)
+	{
+		// Snapshot every published hazard, as integers since Sort dereferences pointer arrays
+		Array<UPTRINT> Hazards;
+		Hazards.Reserve(GNumHazardRecords * HazardPointers::SlotsPerThread);
+		for (HazardRecord* Other = GHazardRecords; Other; Other = Other->Next)
+		{
+			for (int32 i = 0; i < HazardPointers::SlotsPerThread; i++)
+			{
+				if (void* Ptr = Other->Hazards[i])
+				{
+					Hazards.Add(UPTRINT(Ptr));
+				}
+			}
+		}
+
+		Sort(Hazards.Data(), Hazards.Size());
+
+		// Reclaim functions may retire more pointers, so work on a detached list
+		Array<RetiredPtr> Pending = Move(Record->RetireList);
+		for (auto& Retired : Pending)
+		{
+			const int32 Index = Algorithm::LowerBound(Hazards.Data(), Hazards.Size(), UPTRINT(Retired.Ptr));
+			if (Index < Hazards.Size() && Hazards[Index] == UPTRINT(Retired.Ptr))
+			{
+				Record->RetireList.Add(Retired);
+			}
+			else
+			{
+				Retired.Reclaim(Retired.Ptr);
+			}
+		}
+	}
+
+	/**
+	* Releases the calling thread's hazard record when the thread exits. Pointers that are still protected elsewhere stay
+	* in the record's retire list and are picked up by the next owner.
+	*/
+	struct HazardRecordOwner
+	{
+		HazardRecord* Record;
+
+		~HazardRecordOwner()
+		{
+			if (Record)
+			{
+				for (int32 i = 0; i < HazardPointers::SlotsPerThread; i++)
+				{
+					Record->Hazards[i] = nullptr;
+				}
+
+				ScanHazardRecord(Record);
+				WindowsAtomics::InterlockedExchange(&Record->bActive, 0);
+			}
+		}
+	};
+
+	static thread_local HazardRecordOwner GHazardRecordOwner;
+
+	static __forceinline HazardRecord* GetHazardRecord()
+	{
+		HazardRecord* Record = GHazardRecordOwner.Record;
+		if (Record == nullptr)
+		{
+			bool bNewRecord;
+			Record = AcquireRecord(GHazardRecords, bNewRecord);
+			if (bNewRecord)
+			{
+				WindowsAtomics::InterlockedIncrement(&GNumHazardRecords);
+			}
+
+			GHazardRecordOwner.Record = Record;
+		}
+
+		return Record;
+	}
+
+	void HazardPointers::Publish(int32 Slot, void* Ptr)
+	{
+		Assert(Slot >= 0 && Slot < SlotsPerThread);
+
+		HazardRecord* Record = GetHazardRecord();
+		WindowsAtomics::InterlockedExchangePtr((void**)&Record->Hazards[Slot], Ptr);
+	}
+
+	void HazardPointers::Clear(int32 Slot)
+	{
+		Assert(Slot >= 0 && Slot < SlotsPerThread);
+
+		HazardRecord* Record = GetHazardRecord();
+		Record->Hazards[Slot] = nullptr;
+	}
+
+	void HazardPointers::ClearAll()
+	{
+		HazardRecord* Record = GetHazardRecord();
+		for (int32 i = 0; i < SlotsPerThread; i++)
+		{
+			Record->Hazards[i] = nullptr;
+		}
+	}
+
+	void HazardPointers::Retire(void* Ptr, ReclaimFunc Reclaim)
+	{
+		Assert(Reclaim);
+		if (Ptr == nullptr)
+		{
+			return;
+		}
+
+		HazardRecord* Record = GetHazardRecord();
+
+		RetiredPtr Retired = { Ptr, Reclaim };
+		Record->RetireList.Add(Retired);
+
+		const int32 Threshold = Math::Max(int32(MinScanThreshold), 2 * GNumHazardRecords * SlotsPerThread);
+		if (Record->RetireList.Size() >= Threshold)
+		{
+			ScanHazardRecord(Record);
+		}
+	}
+
+	void HazardPointers::Scan()
+	{
+		ScanHazardRecord(GetHazardRecord());
+	}
+
+	int32 HazardPointers::GetNumRetired()
+	{
+		return GetHazardRecord()->RetireList.Size();
+	}
+
+	/**
+	* Reads the global epoch with a full barrier, so it can't be reordered with the caller's preceding stores.
+	*/
+	static __forceinline int64 LoadGlobalEpoch()
+	{
+		return WindowsAtomics::InterlockedCompareExchange(&GGlobalEpoch, 0, 0);
+	}
+
+	/**
+	* Reclaims the limbo lists of Record that are at least two epochs behind the global epoch.
+	*/
+	static void ReclaimExpiredLimbo(EpochRecord* Record, int64 GlobalEpoch)
+	{
+		for (int32 i = 0; i < 3; i++)
+		{
+			if (Record->Limbo[i].Size() > 0 && Record->LimboEpoch[i] + 2 <= GlobalEpoch)
+			{
+				Array<RetiredPtr> Expired = Move(Record->Limbo[i]);
+				Reclamation_Private::ReclaimAll(Expired);
+			}
+		}
+	}
+
+	/**
+	* Releases the calling thread's epoch record when the thread exits. Its limbo lists are kept along with their epochs
+	* and reclaimed by the next owner.
+	*/
+	struct EpochRecordOwner
+	{
+		EpochRecord* Record;
+
+		~EpochRecordOwner()
+		{
+			if (Record)
+			{
+				Record->NestCount = 0;
+				WindowsAtomics::InterlockedExchange(&Record->State, Record->State & ~int64(1));
+				ReclaimExpiredLimbo(Record, LoadGlobalEpoch());
+				WindowsAtomics::InterlockedExchange(&Record->bActive, 0);
+			}
+		}
+	};
+
+	static thread_local EpochRecordOwner GEpochRecordOwner;
+
+	static __forceinline EpochRecord* GetEpochRecord()
+	{
+		EpochRecord* Record = GEpochRecordOwner.Record;
+		if (Record == nullptr)
+		{
+			bool bNewRecord;
+			Record = AcquireRecord(GEpochRecords, bNewRecord);
+			GEpochRecordOwner.Record = Record;
+		}
+
+		return Record;
+	}
+
+	void EpochReclamation::Enter()
+	{
+		EpochRecord* Record = GetEpochRecord();
+		if (Record->NestCount++ == 0)
+		{
+			// Announcing a stale epoch is harmless: it only holds the global epoch back
+			const int64 Epoch = GGlobalEpoch;
+			WindowsAtomics::InterlockedExchange(&Record->State, (Epoch << 1) | 1);
+		}
+	}
+
+	void EpochReclamation::Exit()
+	{
+		EpochRecord* Record = GetEpochRecord();
+		Assert(Record->NestCount > 0);
+
+		if (--Record->NestCount == 0)
+		{
+			WindowsAtomics::InterlockedExchange(&Record->State, Record->State & ~int64(1));
+		}
+	}
+
+	bool EpochReclamation::IsPinned()
+	{
+		return GetEpochRecord()->NestCount > 0;
+	}
+
+	void EpochReclamation::Retire(void* Ptr, ReclaimFunc Reclaim)
+	{
+		Assert(Reclaim);
+		if (Ptr == nullptr)
+		{
+			return;
+		}
+
+		EpochRecord* Record = GetEpochRecord();
+
+		const int64 Epoch = LoadGlobalEpoch();
+		const int32 Bucket = int32(Epoch % 3);
+		if (Record->LimboEpoch[Bucket] != Epoch)
+		{
+			// The bucket holds garbage from at least three epochs ago, which is always safe to reclaim
+			Array<RetiredPtr> Expired = Move(Record->Limbo[Bucket]);
+			Record->LimboEpoch[Bucket] = Epoch;
+			Reclamation_Private::ReclaimAll(Expired);
+		}
+
+		RetiredPtr Retired = { Ptr, Reclaim };
+		Record->Limbo[Bucket].Add(Retired);
+
+		if (++Record->RetiresSinceAdvance >= AdvanceInterval)
+		{
+			Record->RetiresSinceAdvance = 0;
+			TryAdvance();
+		}
+	}
+
+	bool EpochReclamation::TryAdvance()
+	{
+		const int64 Epoch = LoadGlobalEpoch();
+
+		bool bCanAdvance = true;
+		for (EpochRecord* Other = GEpochRecords; Other; Other = Other->Next)
+		{
+			const int64 State = Other->State;
+			if ((State & 1) && (State >> 1) != Epoch)
+			{
+				bCanAdvance = false;
+				break;
+			}
+		}
+
+		bool bAdvanced = false;
+		if (bCanAdvance)
+		{
+			bAdvanced = WindowsAtomics::InterlockedCompareExchange(&GGlobalEpoch, Epoch + 1, Epoch) == Epoch;
+		}
+
+		ReclaimExpiredLimbo(GetEpochRecord(), LoadGlobalEpoch());
+		return bAdvanced;
+	}
+
+	void EpochReclamation::Flush()
+	{
+		Assertf(!IsPinned(), EDX_TEXT("EpochReclamation::Flush called from inside a critical section"));
+
+		// Two advances are enough for anything retired so far, a third one covers a concurrent advance in between
+		for (int32 i = 0; i < 3; i++)
+		{
+			TryAdvance();
+		}
+	}
+
+	int64 EpochReclamation::GetGlobalEpoch()
+	{
+		return LoadGlobalEpoch();
+	}
+}
@@ -0,0 +1,249 @@
+#pragma once
+
+#include "Types.h"
+#include "Memory.h"
+#include "../Containers/Array.h"
+#include "../Windows/Atomics.h"
+
+namespace EDX
+{
+	/** Function called to release a retired pointer once no thread can be referencing it anymore. */
+	typedef void(*ReclaimFunc)(void* Ptr);
+
+	/** A pointer that has been unlinked from a lock-free structure and is waiting to be reclaimed. */
+	struct RetiredPtr
+	{
+		void* Ptr;
+		ReclaimFunc Reclaim;
+	};
+
+	namespace Reclamation_Private
+	{
+		/** Default reclaim function, releases a block obtained from Memory::AlignedAlloc or any of the heap allocation policies. */
+		inline void FreeMemory(void* Ptr)
+		{
+			Memory::Free(Ptr);
+		}
+
+		/** Reclaim function for objects constructed in place in a Memory::AlignedAlloc block. */
+		template<typename T>
+		void DestructAndFree(void* Ptr)
+		{
+			((T*)Ptr)->~T();
+			Memory::Free(Ptr);
+		}
+
+		/** Reclaim function for objects allocated with new. */
+		template<typename T>
+		void DeleteObject(void* Ptr)
+		{
+			delete (T*)Ptr;
+		}
+
+		/** Calls the reclaim function of every entry in the list and empties it. */
+		inline void ReclaimAll(Array<RetiredPtr>& List)
+		{
+			for (auto& Retired : List)
+			{
+				Retired.Reclaim(Retired.Ptr);
+			}
+			List.Clear();
+		}
+	}
+
+	/**
+	* Hazard pointer based safe memory reclamation.
+	*
+	* A reader publishes the pointer it is about to dereference in one of its hazard slots; a writer that unlinks a node
+	* retires it instead of freeing it. Retired pointers are collected in a per-thread list and reclaimed in batches,
+	* skipping the ones still published by any thread. Reclamation cost is amortized over the number of hazard slots
+	* in the process, so retiring a pointer is O(1) on average.
+	*
+	* Per-thread records are never freed: a thread that exits releases its record and the next thread to need one
+	* adopts it, together with whatever was left in its retire list.
+	*/
+	class HazardPointers
+	{
+	public:
+		enum
+		{
+			// Number of pointers a single thread can protect at the same time
+			SlotsPerThread = 4,
+
+			// Retire lists shorter than this are never scanned, to keep the reclamation batched
+			MinScanThreshold = 64,
+		};
+
+		/**
+		* Publishes the pointer currently stored in Source in the given slot and returns it. The pointer is re-read after
+		* publication until it is stable, so the returned value is guaranteed not to be reclaimed until the slot is cleared.
+		*/
+		template<typename T>
+		static T* Protect(int32 Slot, T* const volatile& Source)
+		{
+			T* Ptr = Source;
+			for (;;)
+			{
+				Publish(Slot, Ptr);
+
+				T* Reread = Source;
+				if (Reread == Ptr)
+				{
+					return Ptr;
+				}
+
+				Ptr = Reread;
+			}
+		}
+
+		/**
+		* Publishes Ptr in the given slot. The caller is responsible for validating that Ptr is still reachable afterwards.
+		* The store is a full barrier, so a subsequent re-read of the source can't be reordered before it.
+		*/
+		static void Publish(int32 Slot, void* Ptr);
+
+		/** Clears the given hazard slot of the calling thread. */
+		static void Clear(int32 Slot);
+
+		/** Clears every hazard slot of the calling thread. */
+		static void ClearAll();
+
+		/**
+		* Retires a pointer that has been unlinked from a shared structure. It will be passed to Reclaim once no hazard
+		* slot refers to it anymore.
+		*/
+		static void Retire(void* Ptr, ReclaimFunc Reclaim = &Reclamation_Private::FreeMemory);
+
+		/** Retires an object constructed in place in a Memory::AlignedAlloc block. */
+		template<typename T>
+		static void RetireObject(T* Object)
+		{
+			Retire(Object, &Reclamation_Private::DestructAndFree<T>);
+		}
+
+		/** Retires an object allocated with new. */
+		template<typename T>
+		static void RetireDelete(T* Object)
+		{
+			Retire(Object, &Reclamation_Private::DeleteObject<T>);
+		}
+
+		/** Reclaims every pointer in the calling thread's retire list that isn't currently protected. */
+		static void Scan();
+
+		/** @return the number of pointers in the calling thread's retire list. */
+		static int32 GetNumRetired();
+	};
+
+	/**
+	* Epoch based safe memory reclamation.
+	*
+	* Readers pin the current global epoch for the duration of a critical section (see EpochGuard). Retired pointers are
+	* tagged with the epoch they were retired in and kept in one of three limbo lists per thread. The global epoch only
+	* advances when every pinned thread has observed it, so anything retired two epochs ago can no longer be reached and
+	* is reclaimed as a batch.
+	*
+	* Cheaper for readers than hazard pointers (one store per critical section instead of one per pointer), at the cost
+	* of unbounded garbage if a thread stays pinned for a long time.
+	*/
+	class EpochReclamation
+	{
+	public:
+		enum
+		{
+			// Retires between two attempts at advancing the global epoch
+			AdvanceInterval = 64,
+		};
+
+		/** Pins the current epoch for the calling thread. Calls can be nested. */
+		static void Enter();
+
+		/** Unpins the calling thread once the outermost Enter has been matched. */
+		static void Exit();
+
+		/** @return true if the calling thread is currently inside a critical section. */
+		static bool IsPinned();
+
+		/** Retires a pointer, it will be passed to Reclaim once no thread can still be inside a critical section that saw it. */
+		static void Retire(void* Ptr, ReclaimFunc Reclaim = &Reclamation_Private::FreeMemory);
+
+		/** Retires an object constructed in place in a Memory::AlignedAlloc block. */
+		template<typename T>
+		static void RetireObject(T* Object)
+		{
+			Retire(Object, &Reclamation_Private::DestructAndFree<T>);
+		}
+
+		/** Retires an object allocated with new. */
+		template<typename T>
+		static void RetireDelete(T* Object)
+		{
+			Retire(Object, &Reclamation_Private::DeleteObject<T>);
+		}
+
+		/**
+		* Tries to advance the global epoch and reclaims the calling thread's limbo lists that became safe.
+		* @return true if the global epoch was advanced.
+		*/
+		static bool TryAdvance();
+
+		/**
+		* Reclaims as much as possible of the calling thread's garbage, advancing the epoch as many times as needed.
+		* Must not be called from inside a critical section.
+		*/
+		static void Flush();
+
+		/** @return the current global epoch. */
+		static int64 GetGlobalEpoch();
+	};
+
+	/**
+	* Scope level epoch pinning, the epoch equivalent of ScopeLock.
+	*/
+	class EpochGuard
+	{
+	public:
+		EpochGuard()
+		{
+			EpochReclamation::Enter();
+		}
+
+		~EpochGuard()
+		{
+			EpochReclamation::Exit();
+		}
+
+	private:
+		EpochGuard(const EpochGuard&);
+		EpochGuard& operator = (const EpochGuard&);
+	};
+
+	/**
+	* Scope level hazard slot, clears the slot on destruction.
+	*/
+	class HazardGuard
+	{
+	public:
+		explicit HazardGuard(int32 InSlot)
+			: Slot(InSlot)
+		{
+		}
+
+		template<typename T>
+		T* Protect(T* const volatile& Source)
+		{
+			return HazardPointers::Protect(Slot, Source);
+		}
+
+		~HazardGuard()
+		{
+			HazardPointers::Clear(Slot);
+		}
+
+	private:
+		int32 Slot;
+
+		HazardGuard(const HazardGuard&);
+		HazardGuard& operator = (const HazardGuard&);
+	};
+}
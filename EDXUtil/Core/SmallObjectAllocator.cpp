@@ -0,0 +1,296 @@
+
+#include "SmallObjectAllocator.h"
+#include "Memory.h"
+#include "../Containers/LockFreeStack.h"
+#include "../Windows/Base.h"
+
+namespace EDX
+{
+	/**
+	* A free block. Next links batches in the central lists, ChainNext links the blocks of a batch and of a thread's
+	* free list. Both fit in the smallest size class.
+	*/
+	struct FreeBlock
+	{
+		FreeBlock* Next;
+		FreeBlock* ChainNext;
+	};
+
+#if defined(_WIN64)
+	static const SIZE_T ReservedRangeSize = SIZE_T(16) * 1024 * 1024 * 1024;
+#else
+	static const SIZE_T ReservedRangeSize = SIZE_T(256) * 1024 * 1024;
+#endif
+	static const SIZE_T MaxPages = ReservedRangeSize / SmallObjectAllocator::PageSize;
+
+	uint8* SmallObjectAllocator::ReservedBase = nullptr;
+	SIZE_T SmallObjectAllocator::ReservedSize = 0;
+
+	/** Size class of every page handed out so far. */
+	static uint8 GPageSizeClass[MaxPages];
+
+	/** Bytes of the reserved range handed out to spans so far. */
+	static volatile int64 GReservedUsed = 0;
+	static volatile int32 GReserveState = 0;
+
+	/** Full batches of free blocks per size class. */
+	static IntrusiveLockFreeStack<FreeBlock> GCentralLists[SmallObjectAllocator::NumSizeClasses];
+
+	/** Number of blocks moved between a thread cache and the central list at once. */
+	static __forceinline int32 GetBatchCount(int32 SizeClass)
+	{
+		return Math::Clamp(int32(8192 / SmallObjectAllocator::GetClassSize(SizeClass)), 2, 64);
+	}
+
+	/** Bytes carved at once when a size class runs out of blocks, a multiple of the page size. */
+	static __forceinline SIZE_T GetSpanSize(int32 SizeClass)
+	{
+		const SIZE_T Size = Math::Max(SIZE_T(SmallObjectAllocator::GetClassSize(SizeClass)) * 32, SIZE_T(SmallObjectAllocator::PageSize));
+		return Align(Size, int32(SmallObjectAllocator::PageSize));
+	}
+
+	/**
+	* Reserves the address range on first use. The reservation can't happen during static initialization since
+	* allocations may come from other translation units' static constructors first.
+	*/
+	static bool ReserveRange(uint8*& OutBase, SIZE_T& OutSize)
+	{
+		if (GReserveState == 2)
+		{
+			return true;
+		}
+
+		if (WindowsAtomics::InterlockedCompareExchange(&GReserveState, 1, 0) == 0)
+		{
+			void* Base = ::VirtualAlloc(nullptr, ReservedRangeSize, MEM_RESERVE, PAGE_NOACCESS);
+			if (Base)
+			{
+				OutBase = (uint8*)Base;
+				WindowsAtomics::InterlockedExchange(&GReserveState, 2);
+
+				// Publish the size last, Owns can't match anything before
+				OutSize = ReservedRangeSize;
+			}
+			else
+			{
+				WindowsAtomics::InterlockedExchange(&GReserveState, 3);
+			}
+		}
+
+		while (GReserveState == 1)
+		{
+			::SwitchToThread();
+		}
+
+		return GReserveState == 2;
+	}
+
+	/**
+	* Per-thread free lists, returned to the central lists on thread exit.
+	*/
+	struct SmallObjectThreadCache
+	{
+		FreeBlock* Lists[SmallObjectAllocator::NumSizeClasses];
+		int32 Counts[SmallObjectAllocator::NumSizeClasses];
+		bool bDestroyed;
+
+		~SmallObjectThreadCache()
+		{
+			SmallObjectAllocator::FlushThreadCache();
+			bDestroyed = true;
+		}
+	};
+
+	static thread_local SmallObjectThreadCache GThreadCache;
+
+	/** Pushes Count blocks from the front of a thread list to the central list as one batch. */
+	static __forceinline void ReleaseBatch(int32 SizeClass, int32 Count)
+	{
+		FreeBlock* First = GThreadCache.Lists[SizeClass];
+		FreeBlock* Last = First;
+		for (int32 i = 1; i < Count; i++)
+		{
+			Last = Last->ChainNext;
+		}
+
+		GThreadCache.Lists[SizeClass] = Last->ChainNext;
+		GThreadCache.Counts[SizeClass] -= Count;
+
+		Last->ChainNext = nullptr;
+		GCentralLists[SizeClass].Push(First);
+	}
+
+	/**
+	* Carves a new span for the size class. Keeps one batch for the calling thread and publishes the rest.
+	*
+	* @return false if the reserved range is exhausted.
+	*/
+	static bool AllocateSpan(int32 SizeClass, uint8* Base)
+	{
+		const SIZE_T SpanSize = GetSpanSize(SizeClass);
+		const int64 Offset = WindowsAtomics::InterlockedAdd(&GReservedUsed, int64(SpanSize));
+		if (SIZE_T(Offset) + SpanSize > ReservedRangeSize)
+		{
+			return false;
+		}
+
+		uint8* Span = Base + Offset;
+		if (::VirtualAlloc(Span, SpanSize, MEM_COMMIT, PAGE_READWRITE) == nullptr)
+		{
+			return false;
+		}
+
+		const SIZE_T FirstPage = SIZE_T(Offset) / SmallObjectAllocator::PageSize;
+		for (SIZE_T Page = FirstPage; Page < FirstPage + SpanSize / SmallObjectAllocator::PageSize; Page++)
+		{
+			GPageSizeClass[Page] = uint8(SizeClass);
+		}
+
+		// Link every block of the span, then hand out batches from the front
+		const uint32 ClassSize = SmallObjectAllocator::GetClassSize(SizeClass);
+		const int32 NumBlocks = int32(SpanSize / ClassSize);
+		for (int32 i = 0; i < NumBlocks; i++)
+		{
+			FreeBlock* Block = (FreeBlock*)(Span + SIZE_T(i) * ClassSize);
+			Block->ChainNext = i + 1 < NumBlocks ? (FreeBlock*)(Span + SIZE_T(i + 1) * ClassSize) : GThreadCache.Lists[SizeClass];
+		}
+
+		GThreadCache.Lists[SizeClass] = (FreeBlock*)Span;
+		GThreadCache.Counts[SizeClass] += NumBlocks;
+
+		const int32 BatchCount = GetBatchCount(SizeClass);
+		while (GThreadCache.Counts[SizeClass] >= 2 * BatchCount)
+		{
+			ReleaseBatch(SizeClass, BatchCount);
+		}
+
+		return true;
+	}
+
+	int32 SmallObjectAllocator::GetSizeClass(SIZE_T Size, uint32 Alignment)
+	{
+		Alignment = Math::Max(Alignment, 16u);
+		if (Size > MaxSmallSize || Alignment > PageSize)
+		{
+			return INDEX_NONE;
+		}
+
+		const uint32 Rounded = Math::Max(uint32(Align(Size, int32(Alignment))), 16u);
+
+		int32 SizeClass;
+		if (Rounded <= 128)
+		{
+			SizeClass = (Rounded - 1) >> 4;
+		}
+		else
+		{
+			const uint32 Log2 = Math::FloorLog2(Rounded - 1);
+			SizeClass = 8 + (Log2 - 7) * 4 + ((Rounded - 1 - (1u << Log2)) >> (Log2 - 2));
+		}
+
+		// Blocks are aligned to the largest power of two dividing their class size
+		while (SizeClass < NumSizeClasses && (GetClassSize(SizeClass) & (Alignment - 1)) != 0)
+		{
+			SizeClass++;
+		}
+
+		return SizeClass < NumSizeClasses ? SizeClass : INDEX_NONE;
+	}
+
+	void* SmallObjectAllocator::Malloc(SIZE_T Size, uint32 Alignment)
+	{
+		const int32 SizeClass = GetSizeClass(Size, Alignment);
+		if (SizeClass == INDEX_NONE)
+		{
+			return nullptr;
+		}
+
+		if (GThreadCache.bDestroyed)
+		{
+			// Thread is shutting down, don't repopulate its cache
+			return nullptr;
+		}
+
+		FreeBlock* Block = GThreadCache.Lists[SizeClass];
+		if (Block == nullptr)
+		{
+			if (!ReserveRange(ReservedBase, ReservedSize))
+			{
+				return nullptr;
+			}
+
+			if (FreeBlock* Batch = GCentralLists[SizeClass].Pop())
+			{
+				int32 Count = 0;
+				for (FreeBlock* It = Batch; It; It = It->ChainNext)
+				{
+					Count++;
+				}
+
+				GThreadCache.Lists[SizeClass] = Batch;
+				GThreadCache.Counts[SizeClass] = Count;
+			}
+			else if (!AllocateSpan(SizeClass, ReservedBase))
+			{
+				return nullptr;
+			}
+
+			Block = GThreadCache.Lists[SizeClass];
+		}
+
+		GThreadCache.Lists[SizeClass] = Block->ChainNext;
+		GThreadCache.Counts[SizeClass]--;
+
+		return Block;
+	}
+
+	void SmallObjectAllocator::Free(void* Ptr)
+	{
+		Assert(Owns(Ptr));
+
+		const int32 SizeClass = GPageSizeClass[(UPTRINT(Ptr) - UPTRINT(ReservedBase)) / PageSize];
+		FreeBlock* Block = (FreeBlock*)Ptr;
+
+		if (GThreadCache.bDestroyed)
+		{
+			Block->ChainNext = nullptr;
+			GCentralLists[SizeClass].Push(Block);
+			return;
+		}
+
+		Block->ChainNext = GThreadCache.Lists[SizeClass];
+		GThreadCache.Lists[SizeClass] = Block;
+
+		const int32 BatchCount = GetBatchCount(SizeClass);
+		if (++GThreadCache.Counts[SizeClass] >= 2 * BatchCount)
+		{
+			ReleaseBatch(SizeClass, BatchCount);
+		}
+	}
+
+	SIZE_T SmallObjectAllocator::GetAllocSize(const void* Ptr)
+	{
+		Assert(Owns(Ptr));
+
+		const int32 SizeClass = GPageSizeClass[(UPTRINT(Ptr) - UPTRINT(ReservedBase)) / PageSize];
+		return GetClassSize(SizeClass);
+	}
+
+	SIZE_T SmallObjectAllocator::QuantizeSize(SIZE_T Size, uint32 Alignment)
+	{
+		const int32 SizeClass = GetSizeClass(Size, Alignment);
+		return SizeClass != INDEX_NONE ? GetClassSize(SizeClass) : Size;
+	}
+
+	void SmallObjectAllocator::FlushThreadCache()
+	{
+		for (int32 SizeClass = 0; SizeClass < NumSizeClasses; SizeClass++)
+		{
+			const int32 BatchCount = GetBatchCount(SizeClass);
+			while (GThreadCache.Counts[SizeClass] > 0)
+			{
+				ReleaseBatch(SizeClass, Math::Min(BatchCount, GThreadCache.Counts[SizeClass]));
+			}
+		}
+	}
+}
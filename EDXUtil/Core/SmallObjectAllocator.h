@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Types.h"
+
+namespace EDX
+{
+	/**
+	* Thread caching size class allocator for small blocks.
+	*
+	* Requests up to MaxSmallSize bytes are rounded up to one of NumSizeClasses size classes (16-byte steps up to 128 bytes,
+	* then four classes per power of two). Each class is served from spans carved out of a single reserved address range,
+	* committed on demand, so ownership of a pointer is a range check and its size class a table lookup.
+	*
+	* Every thread keeps a free list per size class and only touches shared state when its list runs empty or grows
+	* past two batches; blocks then move between the thread and a lock-free central list per class one batch at a time.
+	* Memory is never returned to the OS, freed blocks are only recycled.
+	*
+	* Used as the backend of Memory::AlignedAlloc and friends when EDX_USE_SMALL_OBJECT_ALLOCATOR is set, in which case
+	* all the heap allocation policies go through it transparently.
+	*/
+	class SmallObjectAllocator
+	{
+	public:
+		enum
+		{
+			// Largest request served by the allocator, larger ones go to the system allocator
+			MaxSmallSize = 32768,
+
+			// Number of size classes up to MaxSmallSize
+			NumSizeClasses = 40,
+
+			// Allocation granularity of the spans, also the largest alignment that can be honored
+			PageSize = 65536,
+		};
+
+		/**
+		* Allocates a block of at least Size bytes aligned to Alignment.
+		*
+		* @return the block, or nullptr if the request is too large, the alignment can't be honored or the reserved range is exhausted
+		*/
+		static void* Malloc(SIZE_T Size, uint32 Alignment);
+
+		/** Frees a block returned by Malloc. */
+		static void Free(void* Ptr);
+
+		/** @return true if Ptr was returned by Malloc. */
+		static __forceinline bool Owns(const void* Ptr)
+		{
+			return UPTRINT(Ptr) - UPTRINT(ReservedBase) < ReservedSize;
+		}
+
+		/** @return the usable size of a block returned by Malloc. */
+		static SIZE_T GetAllocSize(const void* Ptr);
+
+		/**
+		* @return the size of the block Malloc would return for the request, or Size itself if it would not be served by
+		* this allocator.
+		*/
+		static SIZE_T QuantizeSize(SIZE_T Size, uint32 Alignment);
+
+		/** @return the size class index for a request, or INDEX_NONE if it would not be served by this allocator. */
+		static int32 GetSizeClass(SIZE_T Size, uint32 Alignment);
+
+		/** @return the block size of a size class. */
+		static __forceinline uint32 GetClassSize(int32 SizeClass)
+		{
+			if (SizeClass < 8)
+			{
+				return (SizeClass + 1) * 16;
+			}
+
+			const uint32 Log2 = 7 + (SizeClass - 8) / 4;
+			const uint32 Step = (SizeClass - 8) % 4;
+
+			return (1u << Log2) + (Step + 1) * (1u << (Log2 - 2));
+		}
+
+		/** Returns the calling thread's cached blocks to the central lists. Called automatically on thread exit. */
+		static void FlushThreadCache();
+
+	private:
+		static uint8* ReservedBase;
+		static SIZE_T ReservedSize;
+	};
+}
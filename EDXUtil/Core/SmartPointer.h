@@ -132,6 +132,42 @@ namespace EDX
 			return new ReferenceControllerWithDeleter<ObjectType, typename RemoveReference<DeleterType>::Type>(Object, Forward<DeleterType>(Deleter));
 		}
 
+		/**
+		* Reference controller storing the object inline, so the object and its reference counts share a single
+		* allocation and cache line.  The storage is released along with the controller, once the last weak
+		* reference goes away.  Created by MakeShared().
+		*/
+		template <typename ObjectType>
+		class IntrusiveReferenceController : public ReferenceControllerBase
+		{
+		public:
+			template <typename... ArgTypes>
+			explicit IntrusiveReferenceController(ArgTypes&&... Args)
+				: ReferenceControllerBase(nullptr)
+			{
+				Object = new((void*)&ObjectStorage) ObjectType(Forward<ArgTypes>(Args)...);
+			}
+
+			__forceinline ObjectType* GetObjectPtr() const
+			{
+				return (ObjectType*)&ObjectStorage;
+			}
+
+			virtual void DestroyObject()
+			{
+				// Destroy in place, the storage belongs to the controller
+				typedef ObjectType DestructorType;
+				GetObjectPtr()->DestructorType::~DestructorType();
+			}
+
+		private:
+			mutable TypeCompatibleBytes<ObjectType> ObjectStorage;
+		};
+
+		/** Wraps an object created by MakeShared() in a shared reference.  Defined after SharedRef. */
+		template <class ObjectType, ESPMode Mode>
+		SharedRef<ObjectType, Mode> MakeSharedRef(ObjectType* InObject, ReferenceControllerBase* InReferenceController);
+
 
 		/** Proxy structure for implicitly converting raw pointers to shared/weak pointers */
 		
@@ -833,7 +869,7 @@ namespace EDX
 
 		__forceinline SharedRef& operator=(SharedRef&& InSharedRef)
 		{
-			FMemory::Memswap(this, &InSharedRef, sizeof(SharedRef));
+			Memory::Memswap(this, &InSharedRef, sizeof(SharedRef));
 			return *this;
 		}
 
@@ -986,8 +1022,22 @@ namespace EDX
 		template< class OtherType, ESPMode OtherMode > friend class SharedPtr;
 		template< class OtherType, ESPMode OtherMode > friend class WeakPtr;
 
+		template< class OtherType, ESPMode OtherMode >
+		friend SharedRef< OtherType, OtherMode > SharedPointerInternals::MakeSharedRef(OtherType* InObject, SharedPointerInternals::ReferenceControllerBase* InReferenceController);
+
 	private:
 
+		/**
+		* Constructs a shared reference from an object and a reference controller already counting one
+		* shared reference to it.  Used by MakeShared().
+		*/
+		__forceinline SharedRef(ObjectType* InObject, SharedPointerInternals::ReferenceControllerBase* InReferenceController)
+			: Object(InObject)
+			, SharedReferenceCount(InReferenceController)
+		{
+			SharedPointerInternals::EnableSharedFromThis(this, InObject, InObject);
+		}
+
 		/** The object we're holding a reference to.  Can be nullptr. */
 		ObjectType* Object;
 
@@ -997,6 +1047,16 @@ namespace EDX
 	};
 
 
+	namespace SharedPointerInternals
+	{
+		template <class ObjectType, ESPMode Mode>
+		__forceinline SharedRef<ObjectType, Mode> MakeSharedRef(ObjectType* InObject, ReferenceControllerBase* InReferenceController)
+		{
+			return SharedRef<ObjectType, Mode>(InObject, InReferenceController);
+		}
+	}
+
+
 	/**
 	* Wrapper for a type that yields a reference to that type.
 	*/
@@ -2088,6 +2148,23 @@ namespace EDX
 	}
 
 
+	/**
+	* Constructs a new object with the given arguments and returns a shared reference to it.
+	*
+	* Unlike MakeShareable(new ObjectType(...)), the object is constructed inside its reference controller: one
+	* allocation instead of two, and dereferencing touches the same cache lines as the reference counts.  The
+	* memory of the object is only released once the last weak pointer to it goes away.
+	*
+	* @param  Args  The arguments to pass to the constructor of ObjectType
+	*/
+	template< class ObjectType, ESPMode Mode = ESPMode::Fast, typename... ArgTypes >
+	__forceinline SharedRef< ObjectType, Mode > MakeShared(ArgTypes&&... Args)
+	{
+		SharedPointerInternals::IntrusiveReferenceController< ObjectType >* Controller = new SharedPointerInternals::IntrusiveReferenceController< ObjectType >(Forward< ArgTypes >(Args)...);
+		return SharedPointerInternals::MakeSharedRef< ObjectType, Mode >(Controller->GetObjectPtr(), (SharedPointerInternals::ReferenceControllerBase*)Controller);
+	}
+
+
 	/**
 	* Given a Array of WeakPtr's, will remove any invalid pointers.
 	* @param  PointerArray  The pointer array to prune invalid pointers out of
@@ -2491,4 +2568,270 @@ namespace EDX
 	{
 		return UniquePtr<T>(new T(Forward<TArgs>(Args)...));
 	}
+
+
+	/**
+	* Base class for objects that count their own references, to be held by RefCountPtr.  The count is updated
+	* with interlocked operations, so references may be added and released from any thread.  The object deletes
+	* itself when the last reference is released.
+	*/
+	class RefCountedObject
+	{
+	public:
+		RefCountedObject()
+			: NumRefs(0)
+		{
+		}
+
+		virtual ~RefCountedObject()
+		{
+			Assert(NumRefs == 0);
+		}
+
+		RefCountedObject(const RefCountedObject&) = delete;
+		RefCountedObject& operator=(const RefCountedObject&) = delete;
+
+		/** @return the new reference count */
+		__forceinline uint32 AddRef() const
+		{
+			return uint32(WindowsAtomics::InterlockedIncrement(&NumRefs));
+		}
+
+		/** @return the new reference count, the object has been deleted if it is 0 */
+		__forceinline uint32 Release() const
+		{
+			Assert(NumRefs > 0);
+
+			const int32 Refs = WindowsAtomics::InterlockedDecrement(&NumRefs);
+			if (Refs == 0)
+			{
+				delete this;
+			}
+
+			return uint32(Refs);
+		}
+
+		__forceinline uint32 GetRefCount() const
+		{
+			return uint32(static_cast<int32 const volatile&>(NumRefs));
+		}
+
+	private:
+		mutable int32 NumRefs;
+	};
+
+
+	/**
+	* Intrusive reference counted pointer.  Works with any type providing AddRef() and Release(), Release()
+	* being responsible for destroying the object once its count drops to zero, e.g. RefCountedObject.
+	*
+	* The counts live in the object itself: no controller allocation, no weak references, and the pointer
+	* is the size of a raw pointer.  A raw pointer to the object can be turned back into a RefCountPtr at any time.
+	*/
+	template<typename ReferencedType>
+	class RefCountPtr
+	{
+	public:
+		__forceinline RefCountPtr()
+			: Reference(nullptr)
+		{
+		}
+
+		__forceinline RefCountPtr(TYPE_OF_NULLPTR)
+			: Reference(nullptr)
+		{
+		}
+
+		/**
+		* @param  InReference  The object to reference
+		* @param  bAddRef      If false, the pointer adopts a reference the caller already holds
+		*/
+		RefCountPtr(ReferencedType* InReference, bool bAddRef = true)
+			: Reference(InReference)
+		{
+			if (Reference && bAddRef)
+			{
+				Reference->AddRef();
+			}
+		}
+
+		RefCountPtr(const RefCountPtr& Copy)
+			: Reference(Copy.Reference)
+		{
+			if (Reference)
+			{
+				Reference->AddRef();
+			}
+		}
+
+		template<typename OtherType, typename = typename EnableIf<PointerIsConvertibleFromTo<OtherType, ReferencedType>::Value>::Type>
+		RefCountPtr(const RefCountPtr<OtherType>& Copy)
+			: Reference(Copy.GetReference())
+		{
+			if (Reference)
+			{
+				Reference->AddRef();
+			}
+		}
+
+		__forceinline RefCountPtr(RefCountPtr&& Move)
+			: Reference(Move.Reference)
+		{
+			Move.Reference = nullptr;
+		}
+
+		~RefCountPtr()
+		{
+			if (Reference)
+			{
+				Reference->Release();
+			}
+		}
+
+		RefCountPtr& operator=(ReferencedType* InReference)
+		{
+			// AddRef first, the new reference may be kept alive by the old one only
+			ReferencedType* OldReference = Reference;
+			Reference = InReference;
+			if (Reference)
+			{
+				Reference->AddRef();
+			}
+			if (OldReference)
+			{
+				OldReference->Release();
+			}
+
+			return *this;
+		}
+
+		__forceinline RefCountPtr& operator=(const RefCountPtr& Other)
+		{
+			return *this = Other.Reference;
+		}
+
+		RefCountPtr& operator=(RefCountPtr&& Other)
+		{
+			if (this != &Other)
+			{
+				ReferencedType* OldReference = Reference;
+				Reference = Other.Reference;
+				Other.Reference = nullptr;
+				if (OldReference)
+				{
+					OldReference->Release();
+				}
+			}
+
+			return *this;
+		}
+
+		__forceinline ReferencedType* operator->() const
+		{
+			Assert(Reference != nullptr);
+			return Reference;
+		}
+
+		__forceinline ReferencedType& operator*() const
+		{
+			Assert(Reference != nullptr);
+			return *Reference;
+		}
+
+		__forceinline ReferencedType* GetReference() const
+		{
+			return Reference;
+		}
+
+		__forceinline bool IsValid() const
+		{
+			return Reference != nullptr;
+		}
+
+		__forceinline explicit operator bool() const
+		{
+			return Reference != nullptr;
+		}
+
+		/** Drops the reference, if any. */
+		__forceinline void SafeRelease()
+		{
+			*this = nullptr;
+		}
+
+		/** @return the reference count of the object, 0 if the pointer is null */
+		uint32 GetRefCount() const
+		{
+			if (Reference)
+			{
+				// Count the reference added by the AddRef call, then drop it
+				Reference->AddRef();
+				return Reference->Release();
+			}
+
+			return 0;
+		}
+
+		__forceinline void Swap(RefCountPtr& Other)
+		{
+			ReferencedType* OldReference = Reference;
+			Reference = Other.Reference;
+			Other.Reference = OldReference;
+		}
+
+		/**
+		* Gives up the reference without releasing it.  The caller becomes responsible for calling Release().
+		*
+		* @return the referenced object
+		*/
+		__forceinline ReferencedType* Detach()
+		{
+			ReferencedType* OldReference = Reference;
+			Reference = nullptr;
+			return OldReference;
+		}
+
+		friend uint32 GetTypeHash(const RefCountPtr& InPtr)
+		{
+			return PointerHash(InPtr.Reference);
+		}
+
+	private:
+		ReferencedType* Reference;
+	};
+
+	template<typename LhsType, typename RhsType>
+	__forceinline bool operator==(const RefCountPtr<LhsType>& Lhs, const RefCountPtr<RhsType>& Rhs)
+	{
+		return Lhs.GetReference() == Rhs.GetReference();
+	}
+
+	template<typename LhsType, typename RhsType>
+	__forceinline bool operator!=(const RefCountPtr<LhsType>& Lhs, const RefCountPtr<RhsType>& Rhs)
+	{
+		return Lhs.GetReference() != Rhs.GetReference();
+	}
+
+	template<typename ReferencedType>
+	__forceinline bool operator==(const RefCountPtr<ReferencedType>& Lhs, ReferencedType* Rhs)
+	{
+		return Lhs.GetReference() == Rhs;
+	}
+
+	template<typename ReferencedType>
+	__forceinline bool operator!=(const RefCountPtr<ReferencedType>& Lhs, ReferencedType* Rhs)
+	{
+		return Lhs.GetReference() != Rhs;
+	}
+
+	/**
+	* Constructs a new reference counted object with the given arguments and returns a RefCountPtr to it.
+	*
+	* @param Args The arguments to pass to the constructor of T.
+	*/
+	template <typename T, typename... TArgs>
+	__forceinline RefCountPtr<T> MakeRefCount(TArgs&&... Args)
+	{
+		return RefCountPtr<T>(new T(Forward<TArgs>(Args)...));
+	}
 }
\ No newline at end of file
@@ -11,6 +11,8 @@ namespace EDX
 		const bool forceComputeNormal,
 		const bool makeLeftHanded)
 	{
+		EDX_MEMORY_TAG_SCOPE(Mesh);
+
 		Array<Vector3> positionBuf;
 		Array<Vector3> normalBuf;
 		Array<float> texCoordBuf;
@@ -297,17 +299,8 @@ namespace EDX
 			ComputeVertexNormals();
 
 		// Delete cache
-		for (uint i = 0; i < mCache.Size(); i++)
-		{
-			CacheEntry* pEntry = mCache[i];
-			while (pEntry != NULL)
-			{
-				CacheEntry* pNext = pEntry->pNext;
-				Memory::SafeDelete(pEntry);
-				pEntry = pNext;
-			}
-		}
 		mCache.Clear();
+		mCacheEntryPool.Empty();
 
 		if (strMaterialFilename[0])
 		{
@@ -355,7 +348,7 @@ namespace EDX
 			iIndex = mVertices.Size();
 			mVertices.Add(*pVertex);
 
-			CacheEntry* pEntryNew = new CacheEntry();
+			CacheEntry* pEntryNew = mCacheEntryPool.Construct();
 			if (pEntryNew == NULL)
 				return uint(-1);
 
@@ -574,6 +567,8 @@ namespace EDX
 
 	void ObjMesh::LoadPlane(const Vector3& pos, const Vector3& scl, const Vector3& rot, const float length)
 	{
+		EDX_MEMORY_TAG_SCOPE(Mesh);
+
 		Matrix mWorld, mWorldInv;
 		Matrix::CalcTransform(pos, scl, rot, &mWorld, &mWorldInv);
 
@@ -625,6 +620,8 @@ namespace EDX
 
 	void ObjMesh::LoadSphere(const Vector3& pos, const Vector3& scl, const Vector3& rot, const float fRadius, const int slices, const int stacks)
 	{
+		EDX_MEMORY_TAG_SCOPE(Mesh);
+
 		Matrix mWorld, mWorldInv;
 		Matrix::CalcTransform(pos, scl, rot, &mWorld, &mWorldInv);
 
@@ -685,5 +682,6 @@ namespace EDX
 		mIndices.Clear();
 		mFaces.Clear();
 		mCache.Clear();
+		mCacheEntryPool.Empty();
 	}
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 
 #include "../Containers/Array.h"
 #include "../Core/CString.h"
+#include "../Core/ObjectPool.h"
 
 #define MAX_PATH 260
 
@@ -76,6 +77,7 @@ namespace EDX
 		Array<uint> mIndices;
 		Array<MeshFace> mFaces;
 		Array<CacheEntry*> mCache;
+		ObjectPool<CacheEntry> mCacheEntryPool;
 
 		Array<ObjMaterial> mMaterials;
 		Array<uint> mMaterialIdx;
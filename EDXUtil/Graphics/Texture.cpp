@@ -8,12 +8,17 @@ namespace EDX
 	template<uint Dim, typename T, typename Container>
 	void Mipmap<Dim, T, Container>::Generate(const Vec<Dim, int>& dims, const T* pRawTex)
 	{
+		EDX_MEMORY_TAG_SCOPE(Texture);
+
 		mTexDims = dims;
 		mNumLevels = Math::CeilLog2(Math::Max(mTexDims));
 		mNumLevels = Math::Max(mNumLevels, 1);
 
 		mpLeveledTexels = new Container[mNumLevels];
-		mpLeveledTexels[0].Init(mTexDims);
+		for (auto l = 0; l < mNumLevels; l++)
+			mpLeveledTexels[l].SetLargePageMode(mLargePageMode);
+
+		mpLeveledTexels[0].Init(mTexDims, false);
 		mpLeveledTexels[0].SetData(pRawTex);
 
 		Vec<Dim, int> levelDims = mTexDims;
@@ -25,7 +30,7 @@ namespace EDX
 			for (auto d = 0; d < Dim; d++)
 				levelDims[d] = Math::Max(1, levelDims[d]);
 
-			mpLeveledTexels[l].Init(levelDims);
+			mpLeveledTexels[l].Init(levelDims, false);
 			for (auto i = 0; i < mpLeveledTexels[l].LinearSize(); i++)
 			{
 				const Vec<Dim, int> idx = mpLeveledTexels[l].Index(i);
@@ -163,6 +168,8 @@ namespace EDX
 		: mTexWidth(0)
 		, mTexHeight(0)
 	{
+		EDX_MEMORY_TAG_SCOPE(Texture);
+
 		int iChannel;
 		TMem* pRawTex = Bitmap::ReadFromFile<TMem>(strFile, &mTexWidth, &mTexHeight, &iChannel);
 		if (!pRawTex)
@@ -94,10 +94,14 @@ namespace EDX
 		Vec<Dim, int> mOffsetTable[Math::Pow2<Dim>::Value];
 		Vec<Dim, int> mTexDims;
 		int mNumLevels;
+		LargePageMode mLargePageMode;
 
 	public:
 		Container* mpLeveledTexels;
 		Mipmap()
+			: mNumLevels(0)
+			, mLargePageMode(LargePageMode::Default)
+			, mpLeveledTexels(nullptr)
 		{
 			for (uint i = 0; i < Math::Pow2<Dim>::Value; i++)
 				for (uint d = 0; d < Dim; d++)
@@ -111,6 +115,12 @@ namespace EDX
 
 		void Generate(const Vec<Dim, int>& dims, const T* pRawTex);
 
+		/** Selects whether the levels created by Generate allocate from large pages, see DimensionalArray::SetLargePageMode. */
+		void SetLargePageMode(LargePageMode mode)
+		{
+			mLargePageMode = mode;
+		}
+
 		T LinearSample(const Vec<Dim, float>& texCoord, const Vec<Dim, float> differentials[Dim]) const;
 		T TrilinearSample(const Vec<Dim, float>& texCoord, const Vec<Dim, float> differentials[Dim]) const;
 		T SampleLevel_Linear(const Vec<Dim, float>& texCoord, const int level) const;
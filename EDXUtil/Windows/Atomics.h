@@ -4,6 +4,7 @@
 #include "../Core/Template.h"
 
 #define PLATFORM_HAS_64BIT_ATOMICS 1
+#define PLATFORM_CACHE_LINE_SIZE 64
 
 namespace EDX
 {
@@ -1,114 +1,139 @@
 #pragma once
 
+#include "../Core/Memory.h"
 #include "../Containers/Array.h"
+#include "../Containers/Queue.h"
 #include "Base.h"
 
+#include <tuple>
+#include <utility>
+
 namespace EDX
 {
+	/**
+	* A bound listener: a static function, or a member function and the object to call it on.
+	*
+	* Delegates are small values with no virtual functions. The bound function is kept inline next to a call thunk
+	* instantiated for its type, so invoking one is a single indirect call and binding one never allocates.
+	*/
 	template<typename... Params>
 	class Delegate
 	{
 	public:
 		typedef void(*FuncHandler) (Params...);
 
-		virtual void Invoke(Params... params) const = 0;
-		virtual void* GetOwner() const = 0;
-		virtual void* GetFuncHandler() const = 0;
-		virtual Delegate<Params...>* Clone() const = 0;
-		bool operator == (const Delegate<Params...>& other) const
+		/** Big enough for any member function pointer, including those to classes of unknown inheritance. */
+		enum { MaxHandlerSize = sizeof(void*) + 4 * sizeof(int32) };
+
+		Delegate()
+			: mThunk(nullptr)
+			, mpOwner(nullptr)
 		{
-			return GetOwner() == other.GetOwner() && GetFuncHandler() == other.GetFuncHandler();
+			Memory::Memzero(&mHandler, sizeof(mHandler));
 		}
-	};
 
-	template<typename... Params>
-	class StaticFuncDelegate : public Delegate<Params...>
-	{
-	public:
-		typedef void(*FuncHandler) (Params...);
+		static Delegate CreateStatic(FuncHandler func)
+		{
+			Delegate Result;
+			Result.SetHandler(&StaticThunk, nullptr, func);
+			return Result;
+		}
+
+		template<class Class>
+		static Delegate CreateMember(Class* pOwner, void (Class::*func) (Params...))
+		{
+			Delegate Result;
+			Result.SetHandler(&MemberThunk<Class>, pOwner, func);
+			return Result;
+		}
+
+		__forceinline void Invoke(Params... args) const
+		{
+			(*mThunk)(*this, args...);
+		}
+
+		void* GetOwner() const { return mpOwner; }
+		bool IsBound() const { return mThunk != nullptr; }
+
+		bool operator == (const Delegate<Params...>& other) const
+		{
+			return mThunk == other.mThunk
+				&& mpOwner == other.mpOwner
+				&& Memory::Memcmp(&mHandler, &other.mHandler, sizeof(mHandler)) == 0;
+		}
 
 	private:
-		FuncHandler mHandler;
+		typedef void(*ThunkType) (const Delegate&, Params...);
 
-	public:
-		StaticFuncDelegate(FuncHandler func)
-			: mHandler(func)
+		template<typename HandlerType>
+		void SetHandler(ThunkType thunk, void* pOwner, HandlerType func)
 		{
+			static_assert(sizeof(HandlerType) <= MaxHandlerSize, "Function pointer too large for Delegate");
+
+			mThunk = thunk;
+			mpOwner = pOwner;
+
+			// The unused tail stays zeroed so delegates compare bytewise
+			Memory::Memcpy(&mHandler, &func, sizeof(HandlerType));
 		}
 
-		void Invoke(Params... args) const
+		static void StaticThunk(const Delegate& self, Params... args)
+		{
+			(*(const FuncHandler*)&self.mHandler)(args...);
+		}
+
+		template<class Class>
+		static void MemberThunk(const Delegate& self, Params... args)
 		{
-			(*mHandler)(args...);
+			typedef void (Class::*MemberFuncHandler) (Params...);
+			(((Class*)self.mpOwner)->*(*(const MemberFuncHandler*)&self.mHandler))(args...);
 		}
 
-		void* GetOwner() const { return nullptr; }
-		void* GetFuncHandler() const { return (void*)(*(PTRINT*)&mHandler); }
+		ThunkType mThunk;
+		void* mpOwner;
+		AlignedBytes<MaxHandlerSize, sizeof(void*)> mHandler;
+	};
+
+	/** Delegate bound to a static function. */
+	template<typename... Params>
+	class StaticFuncDelegate : public Delegate<Params...>
+	{
+	public:
+		typedef void(*FuncHandler) (Params...);
 
-		virtual Delegate<Params...>* Clone() const
+		StaticFuncDelegate(FuncHandler func)
+			: Delegate<Params...>(Delegate<Params...>::CreateStatic(func))
 		{
-			return new StaticFuncDelegate<Params...>(mHandler);
 		}
 	};
 
+	/** Delegate bound to a member function of an object. */
 	template<class Class, typename... Params>
 	class MemberFuncDelegate : public Delegate<Params...>
 	{
 	public:
 		typedef void (Class::*FuncHandler) (Params...);
 
-	private:
-		Class* mpOwner;
-		FuncHandler mHandler;
-
-	public:
 		MemberFuncDelegate(Class* pOwner, FuncHandler func)
-			: mpOwner(pOwner)
-			, mHandler(func)
-		{
-		}
-
-		void Invoke(Params... args) const
-		{
-			(mpOwner->*mHandler)(args...);
-		}
-
-		void* GetOwner() const { return mpOwner; }
-		void* GetFuncHandler() const { return (void*)(*(PTRINT*)&mHandler); }
-
-		virtual Delegate<Params...>* Clone() const
+			: Delegate<Params...>(Delegate<Params...>::template CreateMember<Class>(pOwner, func))
 		{
-			return new MemberFuncDelegate<Class, Params...>(mpOwner, mHandler);
 		}
 	};
 
 
+	/**
+	* List of listeners invoked in binding order. The delegates are stored by value in a contiguous array.
+	*/
 	template<typename... Params>
 	class Event
 	{
 	protected:
-		Array<Delegate<Params...>*> mListeners;
+		Array<Delegate<Params...>> mListeners;
 
 	public:
 		Event()
 		{
 		}
-		~Event()
-		{
-			Release();
-		}
-
-		Event(const Event<Params...>& other)
-		{
-			operator=(other);
-		}
-
-		Event<Params...>& operator = (const Event<Params...>& other)
-		{
-			Release();
-			for (const auto& it : other.mListeners)
-				mListeners.Add(it->Clone());
-			return *this;
-		}
 
 		Event(typename StaticFuncDelegate<Params...>::FuncHandler pFunc)
 		{
@@ -121,51 +146,53 @@ namespace EDX
 			Bind(pListener, pFunc);
 		}
 
-		void Invoke(Params... args)
+		void Invoke(Params... args) const
 		{
-			for (auto& listener : mListeners)
+			const Delegate<Params...>* pListeners = mListeners.Data();
+			const int32 NumListeners = mListeners.Size();
+			for (int32 i = 0; i < NumListeners; i++)
 			{
-				listener->Invoke(args...);
+				pListeners[i].Invoke(args...);
 			}
 		}
 
 		// For StaticFuncDelegate
 		void Bind(typename StaticFuncDelegate<Params...>::FuncHandler pFunc)
 		{
-			mListeners.Add(new StaticFuncDelegate<Params...>(pFunc));
+			mListeners.Add(StaticFuncDelegate<Params...>(pFunc));
 		}
 
 		void Unbind(typename StaticFuncDelegate<Params...>::FuncHandler pFunc)
 		{
-			StaticFuncDelegate<Params...> tmp = StaticFuncDelegate<Params...>(pFunc);
-			for (auto it = mListeners.begin(); it != mListeners.end(); it++)
-			{
-				if ((**it) == tmp)
-				{
-					delete (*it);
-					mListeners.erase(it);
-					break;
-				}
-			}
+			Unbind(StaticFuncDelegate<Params...>(pFunc));
 		}
 
 		// For MemberFuncDelegate
 		template<class Class>
 		void Bind(Class* pListener, typename MemberFuncDelegate<Class, Params...>::FuncHandler pFunc)
 		{
-			mListeners.Add(new MemberFuncDelegate<Class, Params...>(pListener, pFunc));
+			mListeners.Add(MemberFuncDelegate<Class, Params...>(pListener, pFunc));
 		}
 
 		template<class Class>
 		void Unbind(Class* pListener, typename MemberFuncDelegate<Class, Params...>::FuncHandler pFunc)
 		{
-			MemberFuncDelegate<Class, Params...> tmp = MemberFuncDelegate<Class, Params...>(pListener, pFunc);
-			for (auto it = mListeners.begin(); it != mListeners.end(); it++)
+			Unbind(MemberFuncDelegate<Class, Params...>(pListener, pFunc));
+		}
+
+		void Bind(const Delegate<Params...>& listener)
+		{
+			mListeners.Add(listener);
+		}
+
+		/** Removes the first listener equal to the given one. */
+		void Unbind(const Delegate<Params...>& listener)
+		{
+			for (int32 i = 0; i < mListeners.Size(); i++)
 			{
-				if ((**it) == tmp)
+				if (mListeners[i] == listener)
 				{
-					delete (*it);
-					mListeners.erase(it);
+					mListeners.RemoveAt(i);
 					break;
 				}
 			}
@@ -173,11 +200,6 @@ namespace EDX
 
 		void Release()
 		{
-			for (auto& it : mListeners)
-			{
-				delete it;
-				it = NULL;
-			}
 			mListeners.Clear();
 		}
 
@@ -187,6 +209,79 @@ namespace EDX
 		}
 	};
 
+	/**
+	* Event whose payloads can be posted from any thread and are delivered later, in batches, on the thread calling
+	* Dispatch. Posting pushes the arguments on a multiple-producer single-consumer queue and never runs a listener.
+	*
+	* Useful to hand high frequency input, such as mouse moves and resizes, from the window thread to a render or
+	* simulation thread, which then processes all the accumulated payloads at once.
+	*
+	* The argument types don't need default constructors. Unlike Invoke, every Post allocates a queue node.
+	*/
+	template<typename... Params>
+	class DeferredEvent : public Event<Params...>
+	{
+	private:
+		typedef std::tuple<typename Decay<Params>::Type...> PayloadType;
+
+	public:
+		DeferredEvent()
+			: mDispatchThreadId(0)
+		{
+		}
+
+		/** Queues the arguments for the next Dispatch. Can be called from any thread. */
+		void Post(Params... args)
+		{
+			mPending.Enqueue(PayloadType(args...));
+		}
+
+		/**
+		* Invokes the listeners for the posted payloads, in posting order. Only one thread may ever dispatch.
+		*
+		* @param MaxPayloads Maximum number of payloads delivered by this call, the rest waits for the next one.
+		*                    INDEX_NONE delivers everything posted so far.
+		* @return the number of payloads delivered
+		*/
+		int32 Dispatch(int32 MaxPayloads = INDEX_NONE)
+		{
+			const uint32 ThreadId = ::GetCurrentThreadId();
+			if (mDispatchThreadId == 0)
+			{
+				mDispatchThreadId = ThreadId;
+			}
+			Assertf(mDispatchThreadId == ThreadId, EDX_TEXT("DeferredEvent dispatched from more than one thread"));
+
+			int32 NumDispatched = 0;
+			TypeCompatibleBytes<PayloadType> PayloadStorage;
+			while ((MaxPayloads == INDEX_NONE || NumDispatched < MaxPayloads) && mPending.DequeueUninitialized(PayloadStorage))
+			{
+				PayloadType& Payload = *(PayloadType*)&PayloadStorage;
+				InvokeWithPayload(Payload, std::index_sequence_for<Params...>());
+				DestructItems(&Payload, 1);
+				NumDispatched++;
+			}
+
+			return NumDispatched;
+		}
+
+		/** @return true if payloads are waiting for Dispatch. */
+		bool HasPending() const
+		{
+			return !mPending.IsEmpty();
+		}
+
+	private:
+		template<SIZE_T... Indices>
+		__forceinline void InvokeWithPayload(PayloadType& Payload, std::index_sequence<Indices...>)
+		{
+			this->Invoke(std::get<Indices>(Payload)...);
+		}
+
+		Queue<PayloadType, EQueueMode::Mpsc> mPending;
+		uint32 mDispatchThreadId;
+	};
+
 	class EventArgs : public Object
 	{
 	};
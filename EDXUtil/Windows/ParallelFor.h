@@ -0,0 +1,169 @@
+#pragma once
+
+#include "../Core/Types.h"
+#include "../Core/Memory.h"
+#include "../Containers/Array.h"
+#include "Threading.h"
+
+#include <new>
+#include <ppl.h>
+
+namespace EDX
+{
+	/**
+	* Fixed split of an index range in one contiguous part per thread of the QueuedThreadPool, or per logical
+	* processor if the pool has no threads.
+	*
+	* Memory is placed on the NUMA node of the thread that first touches it. ParallelForStatic always runs part i on
+	* pool worker i, so initializing a large buffer with it, then running the compute loops over the same range with it
+	* as well, keeps each worker on the pages it touched first. Dynamic partitioning, as the default parallel_for does,
+	* loses that.
+	*/
+	class StaticPartition
+	{
+	public:
+		static __forceinline int32 GetNumParts()
+		{
+			const int32 NumWorkers = QueuedThreadPool::Instance()->GetNumThreads();
+			return NumWorkers > 0 ? NumWorkers : GetNumberOfCores();
+		}
+
+		static __forceinline void GetRange(size_t Num, int32 NumParts, int32 Part, size_t& OutBegin, size_t& OutEnd)
+		{
+			OutBegin = Num * Part / NumParts;
+			OutEnd = Num * (Part + 1) / NumParts;
+		}
+	};
+
+	namespace ParallelFor_Private
+	{
+		/** State of one ParallelForStatic call shared with its pool tasks, lives on the caller's stack. */
+		template<typename FuncType>
+		struct StaticDispatch
+		{
+			const FuncType* Func;
+			size_t Num;
+			int32 NumParts;
+			int32 NumWorkers;
+			volatile int32 NumStarted;
+			int32 NumFinished;
+			CriticalSection FinishedLock;
+			ConditionVar FinishedCondVar;
+
+			void RunOnWorker()
+			{
+				// Hold this worker until every worker has picked up one of the tasks, so none of them runs two
+				PlatformAtomics::FetchAdd(&NumStarted, 1);
+				while (PlatformAtomics::Load(&NumStarted, EMemoryOrder::Acquire) < NumWorkers)
+				{
+					::SwitchToThread();
+				}
+
+				const int32 Part = QueuedThreadPool::GetCurrentWorkerIndex();
+				Assert(Part != INDEX_NONE);
+				if (Part < NumParts)
+				{
+					size_t Begin, End;
+					StaticPartition::GetRange(Num, NumParts, Part, Begin, End);
+
+					(*Func)(Begin, End);
+				}
+
+				ScopeLock Lock(&FinishedLock);
+				if (++NumFinished == NumWorkers)
+				{
+					FinishedCondVar.Signal();
+				}
+			}
+		};
+	}
+
+	/**
+	* Runs Func(Begin, End) on every part of the static partition of [0, Num), in parallel, part i on pool worker i.
+	*
+	* One task is queued per pool worker and each waits for all the others to start, so the call occupies the whole
+	* pool and waits for tasks already running to finish first. Called from a pool worker, the whole range runs on the
+	* calling thread instead since the other workers may be waiting on it. Without pool threads, the parts are spread
+	* over the PPL workers with a static partitioner, which doesn't keep a part on the same thread across calls.
+	*
+	* @param MinPartSize Ranges smaller than this many indices per part use fewer parts
+	*/
+	template<typename FuncType>
+	void ParallelForStatic(size_t Num, const FuncType& Func, size_t MinPartSize = 1)
+	{
+		const int32 NumParts = int32(Math::Clamp(Num / Math::Max(MinPartSize, size_t(1)), size_t(1), size_t(StaticPartition::GetNumParts())));
+		if (NumParts == 1 || QueuedThreadPool::GetCurrentWorkerIndex() != INDEX_NONE)
+		{
+			Func(size_t(0), Num);
+			return;
+		}
+
+		QueuedThreadPool* Pool = QueuedThreadPool::Instance();
+		if (Pool->GetNumThreads() == 0)
+		{
+			concurrency::parallel_for(0, NumParts, [&](int32 Part)
+			{
+				size_t Begin, End;
+				StaticPartition::GetRange(Num, NumParts, Part, Begin, End);
+
+				Func(Begin, End);
+			}, concurrency::static_partitioner());
+			return;
+		}
+
+		ParallelFor_Private::StaticDispatch<FuncType> Dispatch;
+		Dispatch.Func = &Func;
+		Dispatch.Num = Num;
+		Dispatch.NumParts = NumParts;
+		Dispatch.NumWorkers = Pool->GetNumThreads();
+		Dispatch.NumStarted = 0;
+		Dispatch.NumFinished = 0;
+
+		for (int32 i = 0; i < Dispatch.NumWorkers; i++)
+		{
+			Pool->AddTask([&Dispatch]() { Dispatch.RunOnWorker(); });
+		}
+
+		ScopeLock Lock(&Dispatch.FinishedLock);
+		while (Dispatch.NumFinished < Dispatch.NumWorkers)
+		{
+			Dispatch.FinishedCondVar.Wait(Dispatch.FinishedLock);
+		}
+	}
+
+	/** Zeroes Num elements of ElementSize bytes with the static partition, see StaticPartition. */
+	inline void ParallelFirstTouchZero(void* Dest, size_t Num, size_t ElementSize)
+	{
+		ParallelForStatic(Num, [&](size_t Begin, size_t End)
+		{
+			Memory::BulkMemzero((uint8*)Dest + Begin * ElementSize, (End - Begin) * ElementSize);
+		}, 65536 / Math::Max(ElementSize, size_t(1)));
+	}
+
+	/** Sets an array to Num copies of Value, constructed in parallel with the static partition. */
+	template<typename ElementType, typename Allocator>
+	void ParallelFirstTouchInit(Array<ElementType, Allocator>& Arr, const ElementType& Value, int32 Num)
+	{
+		Arr.Clear(Num);
+		Arr.AddUninitialized(Num);
+
+		ElementType* pData = Arr.Data();
+		ParallelForStatic(size_t(Num), [&](size_t Begin, size_t End)
+		{
+			for (size_t i = Begin; i < End; i++)
+			{
+				new(pData + i) ElementType(Value);
+			}
+		}, 65536 / sizeof(ElementType));
+	}
+
+	/** Sets an array to Num zeroed elements, cleared in parallel with the static partition. */
+	template<typename ElementType, typename Allocator>
+	void ParallelFirstTouchZeroed(Array<ElementType, Allocator>& Arr, int32 Num)
+	{
+		Arr.Clear(Num);
+		Arr.AddUninitialized(Num);
+
+		ParallelFirstTouchZero(Arr.Data(), size_t(Num), sizeof(ElementType));
+	}
+}
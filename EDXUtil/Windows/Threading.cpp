@@ -72,13 +72,18 @@ namespace EDX
 		return ExitCode;
 	}
 
+	/** Index of the calling thread in its pool, INDEX_NONE for threads not owned by a pool. */
+	static thread_local int32 GCurrentWorkerIndex = INDEX_NONE;
+
 	uint32 QueuedThread::Run()
 	{
+		GCurrentWorkerIndex = WorkerIndex;
+
 		while (!OwningThreadPool->bTerminate)
 		{
 			OwningThreadPool->TaskLock.Lock();
 
-			while (OwningThreadPool->QueuedWorks.IsEmpty() && !OwningThreadPool->bTerminate)
+			while (OwningThreadPool->NumPending == 0 && !OwningThreadPool->bTerminate)
 			{
 				OwningThreadPool->TaskCondVar.Wait(OwningThreadPool->TaskLock);
 			}
@@ -88,15 +93,26 @@ namespace EDX
 				return 0;
 			}
 
-			QueuedWork* pWork;
-			OwningThreadPool->QueuedWorks.Dequeue(pWork);
-			
-			OwningThreadPool->TaskLock.Unlock();
+			{
+				QueuedThreadPool::PendingTask Task;
+				OwningThreadPool->PopTask(Task);
 
-			// Tell the object to do the work
-			pWork->DoThreadedWork();
+				OwningThreadPool->TaskLock.Unlock();
 
-			if (OwningThreadPool->TaskCounter.Decrement() == 0)
+				// Tell the object to do the work
+				if (Task.Work)
+				{
+					Task.Work->DoThreadedWork();
+				}
+				else
+				{
+					Task.Func();
+				}
+
+				// Captures are released here, before the task counts as finished
+			}
+
+			if (OwningThreadPool->TaskCounter->Decrement() == 0)
 			{
 				OwningThreadPool->FinishedCondVar.Signal();
 			}
@@ -120,13 +136,14 @@ namespace EDX
 		return 0;
 	}
 
-	bool QueuedThread::Create(class QueuedThreadPool* InPool, uint32 InStackSize, EThreadPriority ThreadPriority)
+	bool QueuedThread::Create(class QueuedThreadPool* InPool, uint32 InStackSize, EThreadPriority ThreadPriority, int32 InWorkerIndex)
 	{
 		static int32 PoolThreadIndex = 0;
 		const String PoolThreadName = String::Printf(EDX_TEXT("PoolThread %d"), PoolThreadIndex);
 		PoolThreadIndex++;
 
 		OwningThreadPool = InPool;
+		WorkerIndex = InWorkerIndex;
 		Thread = RunnableThread::Create(this, *PoolThreadName, InStackSize, ThreadPriority);
 		Assert(Thread);
 		return true;
@@ -156,6 +173,8 @@ namespace EDX
 
 	bool QueuedThreadPool::Create(uint32 InNumQueuedThreads, uint32 StackSize, EThreadPriority ThreadPriority)
 	{
+		EDX_MEMORY_TAG_SCOPE(Threading);
+
 		// Make sure we have synch objects
 		bool bWasSuccessful = true;
 		ScopeLock Lock(&TaskLock);
@@ -178,7 +197,8 @@ namespace EDX
 			// Create a new queued thread
 			QueuedThread* pThread = new QueuedThread();
 			// Now create the thread and add it if ok
-			if (pThread->Create(this, StackSize, ThreadPriority) == true)
+			Assertf(Count < MaxThreadLocalSlots / 2, EDX_TEXT("Too many pool threads for the ThreadLocal slot range"));
+			if (pThread->Create(this, StackSize, ThreadPriority, Count) == true)
 			{
 				QueuedThreads.Add(pThread);
 			}
@@ -202,7 +222,7 @@ namespace EDX
 	{
 		ScopeLock Lock(&FinishedLock);
 
-		while (TaskCounter.GetValue())
+		while (TaskCounter->GetValue())
 		{
 			FinishedCondVar.Wait(FinishedLock);
 		}
@@ -214,15 +234,22 @@ namespace EDX
 			ScopeLock Lock(&TaskLock);
 			bTerminate = true;
 
-			// Clean up all queued objects
-			QueuedWork* pWork = nullptr;
-			while (QueuedWorks.Dequeue(pWork))
+			// Clean up all queued objects, pending functions are destroyed without running
+			while (NumPending > 0)
 			{
-				pWork->Abandon();
+				PendingTask Task;
+				PopTask(Task);
+
+				if (Task.Work)
+				{
+					Task.Work->Abandon();
+				}
+
+				TaskCounter->Decrement();
 			}
 
-			// Empty out the invalid pointers
-			QueuedWorks.Clear();
+			PendingTasks.Clear();
+			PendingHead = 0;
 		}
 
 		JoinAllThreads();
@@ -248,11 +275,34 @@ namespace EDX
 			return;
 		}
 
+		PendingTask Task;
+		Task.Work = InQueuedWork;
+
 		TaskLock.Lock();
-		QueuedWorks.Enqueue(InQueuedWork);
+		TaskCounter->Increment();
+		PushTask(Move(Task));
+		TaskLock.Unlock();
+
+		TaskCondVar.Broadcast();
+	}
+
+	void QueuedThreadPool::AddTask(TaskFunction&& Func)
+	{
+		Assert(Func);
+
+		if (bTerminate)
+		{
+			return;
+		}
+
+		PendingTask Task;
+		Task.Func = Move(Func);
+
+		TaskLock.Lock();
+		TaskCounter->Increment();
+		PushTask(Move(Task));
 		TaskLock.Unlock();
 
-		TaskCounter.Increment();
 		TaskCondVar.Broadcast();
 	}
 
@@ -265,13 +315,105 @@ namespace EDX
 
 		if (bTerminate)
 		{
-			Assert(QueuedWorks.IsEmpty());  // we better not have anything if we are dying
+			Assert(NumPending == 0);  // we better not have anything if we are dying
 		}
-		if (TaskCounter.GetValue() > 0)
+		if (NumPending > 0 && PendingTasks[PendingHead].Work)
 		{
-			QueuedWorks.Dequeue(Work);
+			PendingTask Task;
+			PopTask(Task);
+			Work = Task.Work;
 		}
 
 		return Work;
 	}
+
+	void QueuedThreadPool::PushTask(PendingTask&& Task)
+	{
+		const int32 Capacity = PendingTasks.Size();
+		if (NumPending == Capacity)
+		{
+			// Grow to the next power of two, unwrapping the ring so the pending tasks start at index 0
+			EDX_MEMORY_TAG_SCOPE(Threading);
+
+			Array<PendingTask> NewTasks;
+			NewTasks.Resize(Math::Max(Capacity * 2, 64));
+			for (int32 i = 0; i < NumPending; i++)
+			{
+				NewTasks[i] = Move(PendingTasks[(PendingHead + i) & (Capacity - 1)]);
+			}
+
+			PendingTasks = Move(NewTasks);
+			PendingHead = 0;
+		}
+
+		PendingTasks[(PendingHead + NumPending) & (PendingTasks.Size() - 1)] = Move(Task);
+		NumPending++;
+	}
+
+	void QueuedThreadPool::PopTask(PendingTask& OutTask)
+	{
+		Assert(NumPending > 0);
+
+		PendingTask& Head = PendingTasks[PendingHead];
+		OutTask.Work = Head.Work;
+		OutTask.Func = Move(Head.Func);
+		Head.Work = nullptr;
+
+		PendingHead = (PendingHead + 1) & (PendingTasks.Size() - 1);
+		NumPending--;
+	}
+
+	int32 QueuedThreadPool::GetCurrentWorkerIndex()
+	{
+		return GCurrentWorkerIndex;
+	}
+
+	/** Slots handed to threads that are not pool threads, allocated from the top of the range. */
+	static int32 GNumExternalSlots = 0;
+	static Array<int32> GFreeExternalSlots;
+	static CriticalSection GExternalSlotLock;
+
+	/**
+	* Returns the calling thread's external slot to the free list when the thread exits.
+	*/
+	struct ExternalThreadLocalSlot
+	{
+		int32 Slot = INDEX_NONE;
+
+		~ExternalThreadLocalSlot()
+		{
+			if (Slot != INDEX_NONE)
+			{
+				ScopeLock Lock(&GExternalSlotLock);
+				GFreeExternalSlots.Add(Slot);
+			}
+		}
+	};
+
+	static thread_local ExternalThreadLocalSlot GExternalSlot;
+
+	int32 GetThreadLocalSlot()
+	{
+		const int32 WorkerIndex = GCurrentWorkerIndex;
+		if (WorkerIndex != INDEX_NONE)
+		{
+			return WorkerIndex;
+		}
+
+		if (GExternalSlot.Slot == INDEX_NONE)
+		{
+			ScopeLock Lock(&GExternalSlotLock);
+			if (GFreeExternalSlots.Size() > 0)
+			{
+				GExternalSlot.Slot = GFreeExternalSlots.Pop();
+			}
+			else
+			{
+				Assertf(GNumExternalSlots < MaxThreadLocalSlots / 2, EDX_TEXT("Too many threads alive using ThreadLocal"));
+				GExternalSlot.Slot = MaxThreadLocalSlots - 1 - GNumExternalSlots++;
+			}
+		}
+
+		return GExternalSlot.Slot;
+	}
 }
\ No newline at end of file
@@ -1,9 +1,13 @@
 #pragma once
 
 #include "../Core/Types.h"
+#include "../Core/Memory.h"
+#include "../Core/PlatformAtomics.h"
+#include "../Core/Function.h"
 #include "../Containers/Queue.h"
 #include "../Containers/String.h"
 #include "Base.h"
+#include "Atomics.h"
 
 namespace EDX
 {
@@ -144,6 +148,93 @@ namespace EDX
 		CriticalSection* SynchObject;
 	};
 
+
+	/**
+	* Reader-writer lock, a pointer sized Windows slim reader/writer lock. Any number of readers can hold it at
+	* the same time, writers get it exclusively. Uncontended locks and unlocks are a single interlocked
+	* operation, without the kernel object and spinning setup of CriticalSection. Not recursive.
+	*/
+	class RWLock
+	{
+	public:
+		RWLock(const RWLock&) = delete;
+		RWLock& operator=(const RWLock&) = delete;
+
+		__forceinline RWLock()
+		{
+			InitializeSRWLock(&mLock);
+		}
+
+		__forceinline void ReadLock()
+		{
+			AcquireSRWLockShared(&mLock);
+		}
+
+		__forceinline void ReadUnlock()
+		{
+			ReleaseSRWLockShared(&mLock);
+		}
+
+		__forceinline void WriteLock()
+		{
+			AcquireSRWLockExclusive(&mLock);
+		}
+
+		__forceinline void WriteUnlock()
+		{
+			ReleaseSRWLockExclusive(&mLock);
+		}
+
+	private:
+		SRWLOCK mLock;
+	};
+
+	/** Holds a RWLock for reading in the scope of the lock object. */
+	class ReadScopeLock
+	{
+	public:
+		ReadScopeLock() = delete;
+		ReadScopeLock(const ReadScopeLock&) = delete;
+		ReadScopeLock& operator=(const ReadScopeLock&) = delete;
+
+		explicit ReadScopeLock(RWLock& InLock)
+			: Lock(InLock)
+		{
+			Lock.ReadLock();
+		}
+
+		~ReadScopeLock()
+		{
+			Lock.ReadUnlock();
+		}
+
+	private:
+		RWLock& Lock;
+	};
+
+	/** Holds a RWLock for writing in the scope of the lock object. */
+	class WriteScopeLock
+	{
+	public:
+		WriteScopeLock() = delete;
+		WriteScopeLock(const WriteScopeLock&) = delete;
+		WriteScopeLock& operator=(const WriteScopeLock&) = delete;
+
+		explicit WriteScopeLock(RWLock& InLock)
+			: Lock(InLock)
+		{
+			Lock.WriteLock();
+		}
+
+		~WriteScopeLock()
+		{
+			Lock.WriteUnlock();
+		}
+
+	private:
+		RWLock& Lock;
+	};
+
 	class ConditionVar
 	{
 	public:
@@ -316,7 +407,7 @@ namespace EDX
 		*/
 		int32 Increment()
 		{
-			return WindowsAtomics::InterlockedIncrement(&Counter);
+			return PlatformAtomics::FetchAdd(&Counter, 1) + 1;
 		}
 
 		/**
@@ -328,7 +419,7 @@ namespace EDX
 		*/
 		int32 Add(int32 Amount)
 		{
-			return WindowsAtomics::InterlockedAdd(&Counter, Amount);
+			return PlatformAtomics::FetchAdd(&Counter, Amount);
 		}
 
 		/**
@@ -339,7 +430,7 @@ namespace EDX
 		*/
 		int32 Decrement()
 		{
-			return WindowsAtomics::InterlockedDecrement(&Counter);
+			return PlatformAtomics::FetchSub(&Counter, 1) - 1;
 		}
 
 		/**
@@ -351,7 +442,7 @@ namespace EDX
 		*/
 		int32 Subtract(int32 Amount)
 		{
-			return WindowsAtomics::InterlockedAdd(&Counter, -Amount);
+			return PlatformAtomics::FetchSub(&Counter, Amount);
 		}
 
 		/**
@@ -363,7 +454,7 @@ namespace EDX
 		*/
 		int32 Set(int32 Value)
 		{
-			return WindowsAtomics::InterlockedExchange(&Counter, Value);
+			return PlatformAtomics::Exchange(&Counter, Value);
 		}
 
 		/**
@@ -374,7 +465,7 @@ namespace EDX
 		*/
 		int32 Reset()
 		{
-			return WindowsAtomics::InterlockedExchange(&Counter, 0);
+			return PlatformAtomics::Exchange(&Counter, 0);
 		}
 
 		/**
@@ -384,7 +475,7 @@ namespace EDX
 		*/
 		int32 GetValue() const
 		{
-			return Counter;
+			return PlatformAtomics::Load(&Counter, EMemoryOrder::Relaxed);
 		}
 
 	private:
@@ -394,6 +485,135 @@ namespace EDX
 	};
 
 
+	/**
+	* Wraps a value so that it occupies its own cache line(s).
+	*
+	* Use for data written frequently by one or more threads that sits next to other shared data, to avoid false sharing.
+	* The alignment only holds for memory from Memory::AlignedAlloc, or inside objects that are themselves aligned; MSVC's
+	* operator new only aligns to 16 bytes, so heap objects with a CacheLinePadded member must be aligned allocated.
+	*/
+	template<typename T>
+	struct __declspec(align(PLATFORM_CACHE_LINE_SIZE)) CacheLinePadded
+	{
+		T Value;
+
+		CacheLinePadded()
+			: Value()
+		{
+		}
+
+		/** Constructs the value from Args. Never chosen to copy another CacheLinePadded, the copy constructors are. */
+		template<typename FirstArgType, typename... ArgTypes, typename = typename EnableIf<sizeof...(ArgTypes) != 0 || !AreTypesEqual<typename Decay<FirstArgType>::Type, CacheLinePadded>::Value>::Type>
+		explicit CacheLinePadded(FirstArgType&& FirstArg, ArgTypes&&... Args)
+			: Value(Forward<FirstArgType>(FirstArg), Forward<ArgTypes>(Args)...)
+		{
+		}
+
+		CacheLinePadded(const CacheLinePadded&) = default;
+		CacheLinePadded& operator=(const CacheLinePadded&) = default;
+
+		__forceinline T& Get() { return Value; }
+		__forceinline const T& Get() const { return Value; }
+
+		__forceinline T* operator->() { return &Value; }
+		__forceinline const T* operator->() const { return &Value; }
+
+		__forceinline T& operator*() { return Value; }
+		__forceinline const T& operator*() const { return Value; }
+	};
+
+
+	/**
+	* Thread safe counter striped across cache lines.
+	*
+	* Writers update the stripe of the processor they are running on, so concurrent updates from different cores don't
+	* contend on the same cache line. The value is only summed up when read, which makes reads more expensive and not
+	* atomic with respect to concurrent writers. Use for statistics, not for counters whose exact value drives control flow
+	* (use AtomicCounter for those).
+	*/
+	class ShardedCounter
+	{
+	public:
+		/** Default constructor, one stripe per logical processor rounded up to a power of two. */
+		ShardedCounter()
+		{
+			uint32 NumCores = (uint32)GetNumberOfCores();
+			NumStripes = 1;
+			while (NumStripes < NumCores && NumStripes < MaxStripes)
+			{
+				NumStripes <<= 1;
+			}
+
+			Stripes = (CacheLinePadded<volatile int64>*)Memory::AlignedAlloc(NumStripes * sizeof(CacheLinePadded<volatile int64>), PLATFORM_CACHE_LINE_SIZE);
+			for (uint32 i = 0; i < NumStripes; i++)
+			{
+				Stripes[i].Value = 0;
+			}
+		}
+
+		~ShardedCounter()
+		{
+			Memory::SafeFree(Stripes);
+		}
+
+		/** Hidden on purpose, copying would have to sum and would not be thread safe. */
+		ShardedCounter(const ShardedCounter&) = delete;
+		void operator=(const ShardedCounter&) = delete;
+
+		/** Adds an amount to the calling processor's stripe. */
+		__forceinline void Add(int64 Amount)
+		{
+			WindowsAtomics::InterlockedAdd(&Stripes[GetCurrentProcessorNumber() & (NumStripes - 1)].Value, Amount);
+		}
+
+		__forceinline void Increment()
+		{
+			Add(1);
+		}
+
+		__forceinline void Decrement()
+		{
+			Add(-1);
+		}
+
+		/**
+		* Sums up all stripes.
+		*
+		* @return the current value, concurrent updates may or may not be included
+		*/
+		int64 GetValue() const
+		{
+			int64 Sum = 0;
+			for (uint32 i = 0; i < NumStripes; i++)
+			{
+				Sum += Stripes[i].Value;
+			}
+			return Sum;
+		}
+
+		/**
+		* Resets every stripe to zero.
+		*
+		* @return the value that was removed from the counter
+		*/
+		int64 Reset()
+		{
+			int64 Sum = 0;
+			for (uint32 i = 0; i < NumStripes; i++)
+			{
+				Sum += WindowsAtomics::InterlockedExchange(&Stripes[i].Value, 0);
+			}
+			return Sum;
+		}
+
+	private:
+		enum { MaxStripes = 64 };
+
+		CacheLinePadded<volatile int64>* Stripes;
+		uint32 NumStripes;
+	};
+
+
 	/**
 	* Interface for "runnable" objects.
 	*
@@ -796,6 +1016,12 @@ namespace EDX
 		virtual ~QueuedWork() { }
 	};
 
+	/**
+	* Function run by the thread pool, see QueuedThreadPool::AddTask. Callables of up to 64 bytes, such as lambdas
+	* capturing a handful of pointers, are stored inline.
+	*/
+	typedef UniqueFunction<void(), 64> TaskFunction;
+
 	/**
 	* This is the interface used for all poolable threads. The usage pattern for
 	* a poolable thread is different from a regular thread and this interface
@@ -812,6 +1038,9 @@ namespace EDX
 		/** My Thread  */
 		RunnableThread* Thread;
 
+		/** Index of this thread in its pool, in [0, NumThreads). */
+		int32 WorkerIndex;
+
 		/**
 		* The real thread entry point. It waits for work events to be queued. Once
 		* an event is queued, it executes it and goes back to waiting.
@@ -824,6 +1053,7 @@ namespace EDX
 		QueuedThread()
 			: OwningThreadPool(nullptr)
 			, Thread(nullptr)
+			, WorkerIndex(INDEX_NONE)
 		{ }
 
 		/**
@@ -833,9 +1063,10 @@ namespace EDX
 		* @param InPool The thread pool interface used to place this thread back into the pool of available threads when its work is done
 		* @param InStackSize The size of the stack to create. 0 means use the current thread's stack size
 		* @param ThreadPriority priority of new thread
+		* @param InWorkerIndex index of the thread in the pool, returned by QueuedThreadPool::GetCurrentWorkerIndex on that thread
 		* @return True if the thread and all of its initialization was successful, false otherwise
 		*/
-		bool Create(class QueuedThreadPool* InPool, uint32 InStackSize = 0, EThreadPriority ThreadPriority = TPri_Normal);
+		bool Create(class QueuedThreadPool* InPool, uint32 InStackSize = 0, EThreadPriority ThreadPriority = TPri_Normal, int32 InWorkerIndex = INDEX_NONE);
 
 		/**
 		* Tells the thread to exit. If the caller needs to know when the thread
@@ -863,13 +1094,32 @@ namespace EDX
 
 		/** Default constructor. */
 		QueuedThreadPool()
-			: bTerminate(false)
+			: PendingHead(0)
+			, NumPending(0)
+			, bTerminate(false)
 		{
 		}
 
 	protected:
-		/** The work queue to pull from. */
-		Queue<QueuedWork*> QueuedWorks;
+		/** A pending work item, either a QueuedWork object or a function. */
+		struct PendingTask
+		{
+			PendingTask()
+				: Work(nullptr)
+			{
+			}
+
+			QueuedWork* Work;
+			TaskFunction Func;
+		};
+
+		/**
+		* The work to pull from, a ring buffer guarded by TaskLock. Slots are reused, so queuing work doesn't
+		* allocate once the ring has grown to the peak number of pending tasks.
+		*/
+		Array<PendingTask> PendingTasks;
+		int32 PendingHead;
+		int32 NumPending;
 
 		/** The thread pool to dole work out to. */
 		Array<QueuedThread*> QueuedThreads;
@@ -884,8 +1134,11 @@ namespace EDX
 		CriticalSection TaskLock;
 		CriticalSection FinishedLock;
 
-		/** The atomic counter that keeps record of number of tasks. */
-		AtomicCounter TaskCounter;
+		/**
+		* The atomic counter that keeps record of number of tasks. Padded since it's written by every worker and by
+		* every submitter, and must stay exact to signal FinishedCondVar.
+		*/
+		CacheLinePadded<AtomicCounter> TaskCounter;
 
 		/** If true, indicates the destruction process has taken place. */
 		bool bTerminate;
@@ -896,7 +1149,11 @@ namespace EDX
 		static QueuedThreadPool* Instance()
 		{
 			if (!mpInstance)
-				mpInstance = new QueuedThreadPool;
+			{
+				// TaskCounter is cache line aligned, operator new wouldn't align the pool for it
+				void* Mem = Memory::AlignedAlloc(sizeof(QueuedThreadPool), PLATFORM_CACHE_LINE_SIZE);
+				mpInstance = new(Mem) QueuedThreadPool;
+			}
 
 			return mpInstance;
 		}
@@ -907,7 +1164,8 @@ namespace EDX
 			{
 				mpInstance->Destroy();
 
-				delete mpInstance;
+				mpInstance->~QueuedThreadPool();
+				Memory::Free(mpInstance);
 				mpInstance = nullptr;
 			}
 		}
@@ -932,7 +1190,7 @@ namespace EDX
 		{
 			// this is a estimate of the number of queued jobs. 
 			// no need for thread safe lock as the queuedWork array isn't moved around in memory so unless this class is being destroyed then we don't need to wrory about it
-			return TaskCounter.GetValue();
+			return TaskCounter->GetValue();
 		}
 
 		int32 GetNumThreads()
@@ -941,7 +1199,193 @@ namespace EDX
 		}
 
 		void AddQueuedWork(QueuedWork* InQueuedWork);
-		
+
+		/**
+		* Queues a function to be run on one of the pool threads. Unlike AddQueuedWork, there is no object to
+		* allocate: small callables are stored inline in the pending task ring. The function is destroyed without
+		* being run if the pool is shutting down.
+		*/
+		void AddTask(TaskFunction&& Task);
+
+		/** @return the next pending QueuedWork, nullptr if there is none or if the next pending task is a function. */
 		QueuedWork* GetNextJob(QueuedThread* InQueuedThread);
+
+		/**
+		* @return the index of the calling thread in its pool, in [0, GetNumThreads()), or INDEX_NONE if the calling
+		* thread is not a pool thread.
+		*/
+		static int32 GetCurrentWorkerIndex();
+
+	private:
+		/** Appends a task to the pending ring, growing it if full. TaskLock must be held. */
+		void PushTask(PendingTask&& Task);
+
+		/** Removes the oldest task from the pending ring, which must not be empty. TaskLock must be held. */
+		void PopTask(PendingTask& OutTask);
+	};
+
+	/** Number of distinct slots available to ThreadLocal instances. */
+	enum { MaxThreadLocalSlots = 256 };
+
+	/**
+	* @return the ThreadLocal slot of the calling thread. Pool threads use their worker index, other threads are handed
+	* slots from the top of the range down, which are recycled when the thread exits.
+	*/
+	int32 GetThreadLocalSlot();
+
+	/**
+	* Per-thread instance of T, created lazily the first time a thread accesses it.
+	*
+	* Each instance lives on its own cache line, so threads can update their copy without synchronization and without
+	* false sharing, and the results can be gathered afterwards with ForEach or Combine. Instances outlive the thread
+	* that created them; a slot released by an exited thread is handed to the next thread with its value intact, which
+	* keeps accumulations correct.
+	*
+	* Get is lock free. ForEach, Combine and Clear are not synchronized with concurrent writers.
+	*/
+	template<typename T>
+	class ThreadLocal
+	{
+	public:
+		ThreadLocal()
+		{
+			for (int32 i = 0; i < MaxThreadLocalSlots; i++)
+			{
+				Slots[i] = nullptr;
+			}
+		}
+
+		/** @param InInitialValue value each instance is copy constructed from */
+		explicit ThreadLocal(const T& InInitialValue)
+			: ThreadLocal()
+		{
+			InitialValue = InInitialValue;
+		}
+
+		~ThreadLocal()
+		{
+			Clear();
+		}
+
+		ThreadLocal(const ThreadLocal&) = delete;
+		void operator=(const ThreadLocal&) = delete;
+
+		/** @return the calling thread's instance, creating it if needed. */
+		__forceinline T& Get()
+		{
+			const int32 Slot = GetThreadLocalSlot();
+
+			CacheLinePadded<T>* Instance = Slots[Slot];
+			if (Instance == nullptr)
+			{
+				Instance = CreateInstance(Slot);
+			}
+
+			return Instance->Value;
+		}
+
+		__forceinline T& operator*() { return Get(); }
+		__forceinline T* operator->() { return &Get(); }
+
+		/** Calls Func on every instance created so far. */
+		template<typename FuncType>
+		void ForEach(FuncType Func)
+		{
+			for (int32 i = 0; i < MaxThreadLocalSlots; i++)
+			{
+				if (CacheLinePadded<T>* Instance = Slots[i])
+				{
+					Func(Instance->Value);
+				}
+			}
+		}
+
+		template<typename FuncType>
+		void ForEach(FuncType Func) const
+		{
+			for (int32 i = 0; i < MaxThreadLocalSlots; i++)
+			{
+				if (const CacheLinePadded<T>* Instance = Slots[i])
+				{
+					Func(Instance->Value);
+				}
+			}
+		}
+
+		/**
+		* Folds every instance created so far with a binary operator, starting from the first instance. Each instance
+		* already started from the initial value, so it isn't folded in once more.
+		*
+		* @param Op binary operator returning the combination of its two arguments
+		* @return the combined value, or the initial value if no thread has accessed this object yet
+		*/
+		template<typename OpType>
+		T Combine(OpType Op) const
+		{
+			bool bFirst = true;
+			T Result = InitialValue;
+			ForEach([&](const T& Value)
+			{
+				Result = bFirst ? Value : Op(Result, Value);
+				bFirst = false;
+			});
+
+			return Result;
+		}
+
+		/**
+		* Folds every instance created so far with a binary operator, starting from Identity.
+		*
+		* @param Identity value that leaves any value unchanged when combined with it, e.g. 0 for a sum
+		* @return the combined value, Identity if no thread has accessed this object yet
+		*/
+		template<typename OpType>
+		T Combine(const T& Identity, OpType Op) const
+		{
+			T Result = Identity;
+			ForEach([&](const T& Value)
+			{
+				Result = Op(Result, Value);
+			});
+
+			return Result;
+		}
+
+		/** @return the number of instances created so far. */
+		int32 GetNumInstances() const
+		{
+			int32 Num = 0;
+			ForEach([&](const T&) { Num++; });
+
+			return Num;
+		}
+
+		/** Destroys all instances. Not thread safe. */
+		void Clear()
+		{
+			for (int32 i = 0; i < MaxThreadLocalSlots; i++)
+			{
+				if (CacheLinePadded<T>* Instance = Slots[i])
+				{
+					Instance->~CacheLinePadded<T>();
+					Memory::Free(Instance);
+					Slots[i] = nullptr;
+				}
+			}
+		}
+
+	private:
+		__declspec(noinline) CacheLinePadded<T>* CreateInstance(int32 Slot)
+		{
+			// Only the thread owning the slot ever creates its instance, no need to race
+			void* Mem = Memory::AlignedAlloc(sizeof(CacheLinePadded<T>), PLATFORM_CACHE_LINE_SIZE);
+			CacheLinePadded<T>* Instance = new(Mem) CacheLinePadded<T>(InitialValue);
+
+			WindowsAtomics::InterlockedExchangePtr((void**)&Slots[Slot], Instance);
+			return Instance;
+		}
+
+		CacheLinePadded<T>* volatile Slots[MaxThreadLocalSlots];
+		T InitialValue = T();
 	};
 }
\ No newline at end of file
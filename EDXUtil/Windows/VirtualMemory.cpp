@@ -0,0 +1,125 @@
+#include "VirtualMemory.h"
+#include "Base.h"
+#include "../Core/Memory.h"
+
+namespace EDX
+{
+	void* VirtualMemory::Reserve(SIZE_T Size)
+	{
+		return ::VirtualAlloc(nullptr, Size, MEM_RESERVE, PAGE_NOACCESS);
+	}
+
+	bool VirtualMemory::Commit(void* Ptr, SIZE_T Size)
+	{
+		return ::VirtualAlloc(Ptr, Size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+	}
+
+	void VirtualMemory::Decommit(void* Ptr, SIZE_T Size)
+	{
+		::VirtualFree(Ptr, Size, MEM_DECOMMIT);
+	}
+
+	void VirtualMemory::Release(void* Ptr)
+	{
+		::VirtualFree(Ptr, 0, MEM_RELEASE);
+	}
+
+	SIZE_T VirtualMemory::GetPageSize()
+	{
+		static SIZE_T PageSize = 0;
+		if (PageSize == 0)
+		{
+			SYSTEM_INFO Info;
+			::GetSystemInfo(&Info);
+			PageSize = Info.dwPageSize;
+		}
+
+		return PageSize;
+	}
+
+	static SIZE_T GLargePageThreshold = 0;
+
+	/** Enables SeLockMemoryPrivilege for the process, large page allocations fail without it. */
+	static bool EnableLockMemoryPrivilege()
+	{
+		HANDLE Token;
+		if (!::OpenProcessToken(::GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &Token))
+		{
+			return false;
+		}
+
+		TOKEN_PRIVILEGES Privileges;
+		Privileges.PrivilegeCount = 1;
+		Privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+		bool bResult = false;
+		if (::LookupPrivilegeValue(nullptr, SE_LOCK_MEMORY_NAME, &Privileges.Privileges[0].Luid))
+		{
+			// AdjustTokenPrivileges succeeds even if the privilege isn't held, the last error tells
+			bResult = ::AdjustTokenPrivileges(Token, FALSE, &Privileges, 0, nullptr, nullptr) && ::GetLastError() == ERROR_SUCCESS;
+		}
+
+		::CloseHandle(Token);
+		return bResult;
+	}
+
+	SIZE_T VirtualMemory::GetLargePageSize()
+	{
+		return ::GetLargePageMinimum();
+	}
+
+	void* VirtualMemory::AllocateLargePages(SIZE_T Size)
+	{
+		static const bool bPrivilegeEnabled = EnableLockMemoryPrivilege();
+
+		const SIZE_T LargePageSize = GetLargePageSize();
+		if (!bPrivilegeEnabled || LargePageSize == 0)
+		{
+			return nullptr;
+		}
+
+		const SIZE_T RoundedSize = (Size + LargePageSize - 1) & ~(LargePageSize - 1);
+		return ::VirtualAlloc(nullptr, RoundedSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+	}
+
+	void VirtualMemory::SetLargePageThreshold(SIZE_T Size)
+	{
+		GLargePageThreshold = Size;
+	}
+
+	SIZE_T VirtualMemory::GetLargePageThreshold()
+	{
+		return GLargePageThreshold;
+	}
+
+	void* VirtualMemory::AllocateBulk(SIZE_T Size, LargePageMode Mode, bool& bOutLargePages)
+	{
+		const bool bTryLargePages = Mode == LargePageMode::Enabled ||
+			(Mode == LargePageMode::Default && GLargePageThreshold > 0 && Size >= GLargePageThreshold);
+
+		if (bTryLargePages)
+		{
+			if (void* Ptr = AllocateLargePages(Size))
+			{
+				bOutLargePages = true;
+				return Ptr;
+			}
+		}
+
+		// Large pages unavailable or fragmented, fall back to the heap
+		bOutLargePages = false;
+		return Memory::AlignedAlloc(Size);
+	}
+
+	void VirtualMemory::FreeBulk(void* Ptr, bool bLargePages)
+	{
+		if (bLargePages)
+		{
+			Release(Ptr);
+		}
+		else
+		{
+			Memory::Free(Ptr);
+		}
+	}
+}
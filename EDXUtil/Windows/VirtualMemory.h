@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../Core/Types.h"
+
+namespace EDX
+{
+	/** Whether a bulk allocation should use large pages, see VirtualMemory::AllocateBulk. */
+	enum class LargePageMode
+	{
+		Default,	// Large pages if the size reaches the threshold set with SetLargePageThreshold
+		Enabled,	// Large pages whenever available
+		Disabled	// Regular heap allocation
+	};
+
+	/**
+	* Thin wrapper over the OS virtual memory API, for allocators that manage address space and physical pages
+	* separately. Reserved ranges are inaccessible until committed, committed pages are zero filled and only backed
+	* by physical memory once touched.
+	*/
+	class VirtualMemory
+	{
+	public:
+		/** @return the base of a reserved range of Size bytes, or nullptr if the address space is exhausted. */
+		static void* Reserve(SIZE_T Size);
+
+		/** Makes pages of a reserved range accessible. Ptr and Size are rounded outwards to the page size. */
+		static bool Commit(void* Ptr, SIZE_T Size);
+
+		/** Returns the physical pages of a committed range to the OS, keeping the addresses reserved. */
+		static void Decommit(void* Ptr, SIZE_T Size);
+
+		/** Releases a whole range returned by Reserve. */
+		static void Release(void* Ptr);
+
+		/** @return the granularity of Commit and Decommit. */
+		static SIZE_T GetPageSize();
+
+		/**
+		* Allocates committed memory backed by large pages, which cut TLB misses on large randomly accessed buffers.
+		* Needs the lock pages in memory privilege, which is enabled for the process on first use if the user holds it.
+		*
+		* @param Size Number of bytes, rounded up to the large page size
+		* @return the allocation, to be freed with Release, or nullptr if large pages are unavailable
+		*/
+		static void* AllocateLargePages(SIZE_T Size);
+
+		/** @return the large page size, or 0 if the system doesn't support them. */
+		static SIZE_T GetLargePageSize();
+
+		/** Sets the size from which LargePageMode::Default allocations try large pages, 0 (the default) disables them. */
+		static void SetLargePageThreshold(SIZE_T Size);
+		static SIZE_T GetLargePageThreshold();
+
+		/**
+		* Allocates a large buffer, from large pages if Mode asks for it and they're available, from the heap otherwise.
+		*
+		* @param bOutLargePages Receives whether large pages were used, to be passed to FreeBulk
+		*/
+		static void* AllocateBulk(SIZE_T Size, LargePageMode Mode, bool& bOutLargePages);
+
+		/** Frees a buffer returned by AllocateBulk. */
+		static void FreeBulk(void* Ptr, bool bLargePages);
+	};
+}
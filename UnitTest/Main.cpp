@@ -1,8 +1,580 @@
 
 #include "EDXPrerequisites.h"
+#include "Containers/FlatHashMap.h"
+#include "Containers/ConcurrentMap.h"
+#include "Containers/DimensionalArray.h"
+#include "Core/SmallObjectAllocator.h"
+#include "Windows/Threading.h"
+#include "Windows/Timer.h"
 
 using namespace EDX;
 
+/** Distinct, scattered keys: multiplying by an odd constant is a bijection on 32 bits. */
+static __forceinline int32 BenchmarkKey(uint32 Index)
+{
+	return int32(Index * 2654435761u);
+}
+
+/** Times insert, lookup hit, lookup miss and erase of NumKeys keys, in nanoseconds per operation. */
+template<typename SetType>
+static void BenchmarkHashSet(const char* Name, int32 NumKeys)
+{
+	Timer BenchTimer;
+	int32 NumFound = 0;
+
+	SetType Elements;
+
+	double Start = BenchTimer.GetAbsoluteTime();
+	for (int32 i = 0; i < NumKeys; i++)
+	{
+		Elements.Add(BenchmarkKey(i));
+	}
+	const double InsertTime = BenchTimer.GetAbsoluteTime() - Start;
+
+	Start = BenchTimer.GetAbsoluteTime();
+	for (int32 i = 0; i < NumKeys; i++)
+	{
+		NumFound += Elements.Contains(BenchmarkKey(i)) ? 1 : 0;
+	}
+	const double HitTime = BenchTimer.GetAbsoluteTime() - Start;
+
+	Start = BenchTimer.GetAbsoluteTime();
+	for (int32 i = 0; i < NumKeys; i++)
+	{
+		NumFound += Elements.Contains(BenchmarkKey(NumKeys + i)) ? 1 : 0;
+	}
+	const double MissTime = BenchTimer.GetAbsoluteTime() - Start;
+
+	Start = BenchTimer.GetAbsoluteTime();
+	for (int32 i = 0; i < NumKeys; i++)
+	{
+		Elements.Remove(BenchmarkKey(i));
+	}
+	const double EraseTime = BenchTimer.GetAbsoluteTime() - Start;
+
+	Assertf(NumFound == NumKeys && Elements.Size() == 0, EDX_TEXT("Hash set benchmark lost keys"));
+
+	const double NsPerOp = 1e9 / NumKeys;
+	printf("%-12s %8d keys: insert %7.2f  hit %7.2f  miss %7.2f  erase %7.2f ns/op\n",
+		Name, NumKeys, InsertTime * NsPerOp, HitTime * NsPerOp, MissTime * NsPerOp, EraseTime * NsPerOp);
+}
+
+/** Compares FlatHashSet with Set, from sizes that fit in L1 to sizes that don't fit in the last level cache. */
+static void BenchmarkFlatHashSet()
+{
+	printf("FlatHashSet vs Set\n");
+
+	const int32 Sizes[] = { 1 << 10, 1 << 16, 1 << 20 };
+	for (int32 i = 0; i < ARRAY_COUNT(Sizes); i++)
+	{
+		BenchmarkHashSet<Set<int32>>("Set", Sizes[i]);
+		BenchmarkHashSet<FlatHashSet<int32>>("FlatHashSet", Sizes[i]);
+	}
+}
+
+/** Map behind a single lock, what shared caches used before ConcurrentMap. */
+class LockedMap
+{
+public:
+	void Add(int32 Key, int32 Value)
+	{
+		ScopeLock Lock(&Mutex);
+		Items.Add(Key, Value);
+	}
+
+	bool Find(int32 Key, int32& OutValue) const
+	{
+		ScopeLock Lock(&Mutex);
+		if (const int32* Value = Items.Find(Key))
+		{
+			OutValue = *Value;
+			return true;
+		}
+		return false;
+	}
+
+	int32 Remove(int32 Key)
+	{
+		ScopeLock Lock(&Mutex);
+		return Items.Remove(Key);
+	}
+
+private:
+	mutable CriticalSection Mutex;
+	Map<int32, int32> Items;
+};
+
+/** Runnable that waits for the other workers of its benchmark, so that thread creation isn't timed. */
+class BenchmarkWorker : public Runnable
+{
+public:
+	BenchmarkWorker()
+		: NumReady(nullptr)
+		, bStart(nullptr)
+	{
+	}
+
+	void SetStartSignal(AtomicCounter* InNumReady, volatile int32* bInStart)
+	{
+		NumReady = InNumReady;
+		bStart = bInStart;
+	}
+
+protected:
+	void WaitForStart()
+	{
+		NumReady->Increment();
+		while (!PlatformAtomics::Load(bStart, EMemoryOrder::Acquire))
+		{
+			::Sleep(0);
+		}
+	}
+
+private:
+	AtomicCounter* NumReady;
+	volatile int32* bStart;
+};
+
+/**
+* Runs every worker on its own thread and releases them together once they have all started.
+* @return the seconds between the release and the end of the last worker
+*/
+template<typename WorkerType>
+static double RunBenchmarkWorkers(const Array<WorkerType*>& Workers)
+{
+	AtomicCounter NumReady;
+	volatile int32 bStart = 0;
+
+	Array<RunnableThread*> Threads;
+	for (int32 i = 0; i < Workers.Size(); i++)
+	{
+		Workers[i]->SetStartSignal(&NumReady, &bStart);
+		Threads.Add(RunnableThread::Create(Workers[i], EDX_TEXT("Benchmark")));
+	}
+
+	while (NumReady.GetValue() < Workers.Size())
+	{
+		::Sleep(0);
+	}
+
+	Timer BenchTimer;
+	const double Start = BenchTimer.GetAbsoluteTime();
+	PlatformAtomics::Store(&bStart, 1, EMemoryOrder::Release);
+
+	for (int32 i = 0; i < Threads.Size(); i++)
+	{
+		Threads[i]->WaitForCompletion();
+	}
+	const double Elapsed = BenchTimer.GetAbsoluteTime() - Start;
+
+	for (int32 i = 0; i < Threads.Size(); i++)
+	{
+		delete Threads[i];
+	}
+
+	return Elapsed;
+}
+
+/** Runs random finds, adds and removes on a shared map. */
+template<typename MapType>
+class MapBenchmarkWorker : public BenchmarkWorker
+{
+public:
+	enum { KeyRange = 1 << 16 };
+
+	MapBenchmarkWorker(MapType& InMap, int32 InNumOps, int32 InWritePercent, uint32 InSeed)
+		: TheMap(InMap)
+		, NumOps(InNumOps)
+		, WritePercent(InWritePercent)
+		, Seed(InSeed)
+	{
+	}
+
+	virtual uint32 Run() override
+	{
+		WaitForStart();
+
+		// xorshift32, the low bits pick the key and the high bits the operation
+		uint32 State = Seed;
+		for (int32 i = 0; i < NumOps; i++)
+		{
+			State ^= State << 13;
+			State ^= State >> 17;
+			State ^= State << 5;
+
+			const int32 Key = int32(State & (KeyRange - 1));
+			if (int32((State >> 16) % 100) < WritePercent)
+			{
+				// Half adds and half removes, so that the map keeps its size
+				if (State & 0x80000000)
+				{
+					TheMap.Add(Key, i);
+				}
+				else
+				{
+					TheMap.Remove(Key);
+				}
+			}
+			else
+			{
+				int32 Value;
+				TheMap.Find(Key, Value);
+			}
+		}
+
+		return 0;
+	}
+
+private:
+	MapType& TheMap;
+	int32 NumOps;
+	int32 WritePercent;
+	uint32 Seed;
+};
+
+/** @return the throughput, in millions of operations per second, of NumThreads threads sharing a half full map. */
+template<typename MapType>
+static double BenchmarkSharedMap(int32 NumThreads, int32 WritePercent)
+{
+	const int32 NumOpsPerThread = (1 << 22) / NumThreads;
+	typedef MapBenchmarkWorker<MapType> WorkerType;
+
+	MapType SharedMap;
+	for (int32 Key = 0; Key < WorkerType::KeyRange; Key += 2)
+	{
+		SharedMap.Add(Key, Key);
+	}
+
+	Array<WorkerType*> Workers;
+	for (int32 i = 0; i < NumThreads; i++)
+	{
+		Workers.Add(new WorkerType(SharedMap, NumOpsPerThread, WritePercent, 0x9E3779B9u * uint32(i + 1)));
+	}
+
+	const double Elapsed = RunBenchmarkWorkers(Workers);
+
+	for (int32 i = 0; i < NumThreads; i++)
+	{
+		delete Workers[i];
+	}
+
+	return double(NumOpsPerThread) * NumThreads / Elapsed * 1e-6;
+}
+
+/** Compares ConcurrentMap with a Map behind one lock, from 1 to 64 threads and for several shares of writes. */
+static void BenchmarkConcurrentMap()
+{
+	printf("ConcurrentMap vs locked Map, Mops/s\n");
+
+	const int32 WritePercents[] = { 0, 10, 50 };
+	for (int32 i = 0; i < ARRAY_COUNT(WritePercents); i++)
+	{
+		printf("%d%% writes\n", WritePercents[i]);
+		for (int32 NumThreads = 1; NumThreads <= 64; NumThreads *= 2)
+		{
+			const double Concurrent = BenchmarkSharedMap<ConcurrentMap<int32, int32>>(NumThreads, WritePercents[i]);
+			const double Locked = BenchmarkSharedMap<LockedMap>(NumThreads, WritePercents[i]);
+			printf("%2d threads: ConcurrentMap %8.2f  locked Map %8.2f\n", NumThreads, Concurrent, Locked);
+		}
+	}
+}
+
+/** Allocation entry points compared by BenchmarkAllocators. */
+struct SmallObjectBenchmarkAllocator
+{
+	static __forceinline void* Malloc(SIZE_T Size)
+	{
+		return SmallObjectAllocator::Malloc(Size, 16);
+	}
+
+	static __forceinline void Free(void* Ptr)
+	{
+		SmallObjectAllocator::Free(Ptr);
+	}
+};
+
+struct CrtBenchmarkAllocator
+{
+	static __forceinline void* Malloc(SIZE_T Size)
+	{
+		return _aligned_malloc(Size, 16);
+	}
+
+	static __forceinline void Free(void* Ptr)
+	{
+		_aligned_free(Ptr);
+	}
+};
+
+/** Replaces random blocks of a per thread working set with new ones of random small sizes. */
+template<typename AllocatorType>
+class AllocBenchmarkWorker : public BenchmarkWorker
+{
+public:
+	enum { NumLive = 1024, MaxSize = 512 };
+
+	AllocBenchmarkWorker(int32 InNumOps, uint32 InSeed)
+		: NumOps(InNumOps)
+		, Seed(InSeed)
+	{
+	}
+
+	virtual uint32 Run() override
+	{
+		void* Live[NumLive] = {};
+
+		WaitForStart();
+
+		uint32 State = Seed;
+		for (int32 i = 0; i < NumOps; i++)
+		{
+			State ^= State << 13;
+			State ^= State >> 17;
+			State ^= State << 5;
+
+			void*& Slot = Live[State & (NumLive - 1)];
+			if (Slot)
+			{
+				AllocatorType::Free(Slot);
+			}
+
+			// Touch the block, as its user would
+			Slot = AllocatorType::Malloc(16 + (State >> 16) % (MaxSize - 15));
+			*(volatile uint8*)Slot = uint8(i);
+		}
+
+		for (int32 i = 0; i < NumLive; i++)
+		{
+			if (Live[i])
+			{
+				AllocatorType::Free(Live[i]);
+			}
+		}
+
+		return 0;
+	}
+
+private:
+	int32 NumOps;
+	uint32 Seed;
+};
+
+/** @return the throughput, in millions of allocation and free pairs per second, of NumThreads threads. */
+template<typename AllocatorType>
+static double BenchmarkAllocator(int32 NumThreads)
+{
+	const int32 NumOpsPerThread = (1 << 22) / NumThreads;
+	typedef AllocBenchmarkWorker<AllocatorType> WorkerType;
+
+	Array<WorkerType*> Workers;
+	for (int32 i = 0; i < NumThreads; i++)
+	{
+		Workers.Add(new WorkerType(NumOpsPerThread, 0x9E3779B9u * uint32(i + 1)));
+	}
+
+	const double Elapsed = RunBenchmarkWorkers(Workers);
+
+	for (int32 i = 0; i < NumThreads; i++)
+	{
+		delete Workers[i];
+	}
+
+	return double(NumOpsPerThread) * NumThreads / Elapsed * 1e-6;
+}
+
+/** Compares SmallObjectAllocator with the CRT heap on blocks of 16 to 512 bytes, from 1 to 64 threads. */
+static void BenchmarkAllocators()
+{
+	printf("SmallObjectAllocator vs _aligned_malloc, Mops/s\n");
+
+	for (int32 NumThreads = 1; NumThreads <= 64; NumThreads *= 2)
+	{
+		const double Small = BenchmarkAllocator<SmallObjectBenchmarkAllocator>(NumThreads);
+		const double Crt = BenchmarkAllocator<CrtBenchmarkAllocator>(NumThreads);
+		printf("%2d threads: SmallObjectAllocator %8.2f  _aligned_malloc %8.2f\n", NumThreads, Small, Crt);
+	}
+}
+
+/** Reads random cells of a Size^3 grid, @return the nanoseconds per read. */
+static double BenchmarkGridGather(uint32 Size, LargePageMode Mode, bool& bOutLargePages)
+{
+	DimensionalArray<3, float> Grid;
+	Grid.SetLargePageMode(Mode);
+	Grid.Init(Vec<3, uint>(Size, Size, Size), false);
+	bOutLargePages = Grid.UsesLargePages();
+
+	// Also faults all the pages in before timing
+	for (size_t i = 0; i < Grid.LinearSize(); i++)
+	{
+		Grid[i] = float(i & 255);
+	}
+
+	const int32 NumReads = 1 << 24;
+	uint32 State = 0x9E3779B9u;
+	float Sum = 0.0f;
+
+	Timer BenchTimer;
+	const double Start = BenchTimer.GetAbsoluteTime();
+	for (int32 i = 0; i < NumReads; i++)
+	{
+		uint32 Coords[3];
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			State ^= State << 13;
+			State ^= State >> 17;
+			State ^= State << 5;
+			Coords[Axis] = State % Size;
+		}
+
+		Sum += Grid[Vec<3, uint>(Coords[0], Coords[1], Coords[2])];
+	}
+	const double Elapsed = BenchTimer.GetAbsoluteTime() - Start;
+
+	// Keeps the reads from being optimized away
+	volatile float Result = Sum;
+	(void)Result;
+
+	return Elapsed * 1e9 / NumReads;
+}
+
+/**
+* Compares random gathers over 3D grids allocated with and without large pages. Large pages need the lock pages in
+* memory privilege, without it both runs use regular pages.
+*/
+static void BenchmarkLargePageGather()
+{
+	printf("DimensionalArray<3, float> random gather, ns/read\n");
+
+	const uint32 Sizes[] = { 256, 512 };
+	for (int32 i = 0; i < ARRAY_COUNT(Sizes); i++)
+	{
+		bool bLargePages;
+		const double Regular = BenchmarkGridGather(Sizes[i], LargePageMode::Disabled, bLargePages);
+		const double Large = BenchmarkGridGather(Sizes[i], LargePageMode::Enabled, bLargePages);
+		printf("%4u^3 (%4u MB): regular pages %6.2f  large pages %6.2f%s\n", Sizes[i], uint32(uint64(Sizes[i]) * Sizes[i] * Sizes[i] * sizeof(float) >> 20),
+			Regular, Large, bLargePages ? "" : " (large pages unavailable, fell back to regular pages)");
+	}
+}
+
+/** Object held by the smart pointer benchmarks, one cache line of data. */
+struct BenchmarkPayload
+{
+	int32 Values[16];
+
+	explicit BenchmarkPayload(int32 Value)
+	{
+		for (int32 i = 0; i < ARRAY_COUNT(Values); i++)
+		{
+			Values[i] = Value;
+		}
+	}
+};
+
+struct RefCountedBenchmarkPayload : public RefCountedObject, public BenchmarkPayload
+{
+	explicit RefCountedBenchmarkPayload(int32 Value)
+		: BenchmarkPayload(Value)
+	{
+	}
+};
+
+/** Ways of creating a shared object compared by BenchmarkSmartPointers, all with thread safe reference counts. */
+struct SharedPtrBenchmarkPolicy
+{
+	typedef SharedPtr<BenchmarkPayload, ESPMode::ThreadSafe> PointerType;
+
+	static __forceinline PointerType Create(int32 Value)
+	{
+		return MakeShareable(new BenchmarkPayload(Value));
+	}
+};
+
+struct MakeSharedBenchmarkPolicy
+{
+	typedef SharedPtr<BenchmarkPayload, ESPMode::ThreadSafe> PointerType;
+
+	static __forceinline PointerType Create(int32 Value)
+	{
+		return MakeShared<BenchmarkPayload, ESPMode::ThreadSafe>(Value);
+	}
+};
+
+struct RefCountPtrBenchmarkPolicy
+{
+	typedef RefCountPtr<RefCountedBenchmarkPayload> PointerType;
+
+	static __forceinline PointerType Create(int32 Value)
+	{
+		return MakeRefCount<RefCountedBenchmarkPayload>(Value);
+	}
+};
+
+/** Times creating NumObjects shared objects, copying every pointer, reading through them and destroying them, in nanoseconds per object. */
+template<typename PolicyType>
+static void BenchmarkSmartPointer(const char* Name, int32 NumObjects)
+{
+	typedef typename PolicyType::PointerType PointerType;
+
+	Array<PointerType> Pointers;
+	Array<PointerType> Copies;
+	Pointers.Reserve(NumObjects);
+	Copies.Reserve(NumObjects);
+
+	Timer BenchTimer;
+
+	double Start = BenchTimer.GetAbsoluteTime();
+	for (int32 i = 0; i < NumObjects; i++)
+	{
+		Pointers.Add(PolicyType::Create(i));
+	}
+	const double CreateTime = BenchTimer.GetAbsoluteTime() - Start;
+
+	Start = BenchTimer.GetAbsoluteTime();
+	for (int32 i = 0; i < NumObjects; i++)
+	{
+		Copies.Add(Pointers[i]);
+	}
+	const double CopyTime = BenchTimer.GetAbsoluteTime() - Start;
+
+	int64 Sum = 0;
+	Start = BenchTimer.GetAbsoluteTime();
+	for (int32 i = 0; i < NumObjects; i++)
+	{
+		Sum += Copies[i]->Values[i & 15];
+	}
+	const double ReadTime = BenchTimer.GetAbsoluteTime() - Start;
+
+	Start = BenchTimer.GetAbsoluteTime();
+	Copies.Clear();
+	Pointers.Clear();
+	const double DestroyTime = BenchTimer.GetAbsoluteTime() - Start;
+
+	Assertf(Sum == int64(NumObjects) * (NumObjects - 1) / 2, EDX_TEXT("Smart pointer benchmark read wrong values"));
+
+	const double NsPerObject = 1e9 / NumObjects;
+	printf("%-12s %8d objects: create %7.2f  copy %7.2f  read %7.2f  destroy %7.2f ns/object\n",
+		Name, NumObjects, CreateTime * NsPerObject, CopyTime * NsPerObject, ReadTime * NsPerObject, DestroyTime * NsPerObject);
+}
+
+/** Compares SharedPtr created by MakeShareable, which allocates the reference controller apart, with MakeShared and RefCountPtr. */
+static void BenchmarkSmartPointers()
+{
+	printf("SharedPtr vs MakeShared vs RefCountPtr\n");
+
+	const int32 Sizes[] = { 1 << 10, 1 << 16, 1 << 20 };
+	for (int32 i = 0; i < ARRAY_COUNT(Sizes); i++)
+	{
+		BenchmarkSmartPointer<SharedPtrBenchmarkPolicy>("SharedPtr", Sizes[i]);
+		BenchmarkSmartPointer<MakeSharedBenchmarkPolicy>("MakeShared", Sizes[i]);
+		BenchmarkSmartPointer<RefCountPtrBenchmarkPolicy>("RefCountPtr", Sizes[i]);
+	}
+}
+
 void main()
 {
-}
\ No newline at end of file
+	BenchmarkFlatHashSet();
+	BenchmarkConcurrentMap();
+	BenchmarkAllocators();
+	BenchmarkLargePageGather();
+	BenchmarkSmartPointers();
+}